@@ -134,7 +134,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface == NULL )
 	{
 		printf( "Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError() );
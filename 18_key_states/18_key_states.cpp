@@ -1,11 +1,33 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <SDL_thread.h>
 #include <stdio.h>
 #include <string>
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int TOTAL_KEY_TEXTURES = 5;
+
+const int MAX_CACHED_TEXTURES = 64;
+const int TEXTURE_CACHE_BUDGET = 32 * 1024 * 1024;
+
+const int MAX_LOAD_REQUESTS = 64;
+const int MAX_LOADER_THREADS = 4;
+
+enum LLoadState
+{
+	LOAD_STATE_PENDING = 0,
+	LOAD_STATE_DECODING = 1,
+	LOAD_STATE_DECODED = 2,
+	LOAD_STATE_DECODE_FAILED = 3,
+	LOAD_STATE_DUPLICATE = 4,
+	LOAD_STATE_LOADED = 5,
+	LOAD_STATE_FAILED = 6
+};
+
+typedef void (*LLoadProgressCallback)( int completed, int total, void* data );
+
 class LTexture
 {
 	public:
@@ -14,6 +36,8 @@ class LTexture
 		~LTexture();
 
 		bool loadFromFile( std::string path );
+
+		bool loadShared( std::string path, SDL_Surface* surface = NULL );
 		
 		#ifdef _SDL_TTF_H
 		bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
@@ -34,30 +58,146 @@ class LTexture
 
 	private:
 		SDL_Texture* mTexture;
+		bool mShared;
 
 		int mWidth;
 		int mHeight;
 };
 
+struct LCachedTexture
+{
+	std::string path;
+	bool colorKey;
+	SDL_TextureAccess access;
+
+	SDL_Texture* texture;
+	int width;
+	int height;
+	int bytes;
+
+	int references;
+	Uint32 lastUsed;
+};
+
+class LTextureCache
+{
+	public:
+		LTextureCache();
+
+		~LTextureCache();
+
+		SDL_Texture* acquire( std::string path, bool colorKey, SDL_TextureAccess access, SDL_Surface* surface, int& width, int& height );
+
+		void release( SDL_Texture* texture );
+
+		bool contains( std::string path, bool colorKey, SDL_TextureAccess access );
+
+		void setBudget( int bytes );
+
+		void free();
+
+		int getHits();
+		int getMisses();
+		int getBytes();
+
+	private:
+		int find( std::string path, bool colorKey, SDL_TextureAccess access );
+
+		void evict( int slotsNeeded );
+
+		LCachedTexture mEntries[ MAX_CACHED_TEXTURES ];
+		int mEntryCount;
+
+		int mBytes;
+		int mBudget;
+
+		int mHits;
+		int mMisses;
+		Uint32 mClock;
+};
+
+struct LLoadRequest
+{
+	std::string path;
+	LTexture* texture;
+	SDL_Surface* surface;
+	LLoadState state;
+	int original;
+};
+
+class LTextureLoader
+{
+	public:
+		LTextureLoader();
+
+		~LTextureLoader();
+
+		bool start( int threadCount );
+
+		void free();
+
+		int request( std::string path, LTexture& texture );
+
+		int upload();
+
+		void setProgressCallback( LLoadProgressCallback callback, void* data );
+
+		bool isReady( int handle );
+		bool isLoaded( int handle );
+		bool isFinished();
+
+		int getCompleted();
+		int getTotal();
+
+	private:
+		static int workerThread( void* data );
+
+		static SDL_Surface* decode( std::string path );
+
+		void work();
+
+		LLoadRequest mRequests[ MAX_LOAD_REQUESTS ];
+		int mRequestCount;
+		int mNextPending;
+		int mCompleted;
+
+		SDL_Thread* mThreads[ MAX_LOADER_THREADS ];
+		int mThreadCount;
+
+		SDL_mutex* mLock;
+		SDL_cond* mPending;
+		bool mQuit;
+
+		LLoadProgressCallback mProgressCallback;
+		void* mProgressData;
+};
+
 bool init();
 
 bool loadMedia();
 
+void renderLoadingScreen( int completed, int total, void* data );
+
 void close();
 
 SDL_Window* gWindow = NULL;
 
 SDL_Renderer* gRenderer = NULL;
 
+LTextureCache gTextureCache;
+
 LTexture gPressTexture;
 LTexture gUpTexture;
 LTexture gDownTexture;
 LTexture gLeftTexture;
 LTexture gRightTexture;
 
+LTextureLoader gTextureLoader;
+
 LTexture::LTexture()
 {
 	mTexture = NULL;
+	mShared = false;
 	mWidth = 0;
 	mHeight = 0;
 }
@@ -100,12 +240,22 @@ bool LTexture::loadFromFile( std::string path )
 	return mTexture != NULL;
 }
 
+bool LTexture::loadShared( std::string path, SDL_Surface* surface )
+{
+	free();
+
+	mTexture = gTextureCache.acquire( path, true, SDL_TEXTUREACCESS_STATIC, surface, mWidth, mHeight );
+	mShared = mTexture != NULL;
+
+	return mTexture != NULL;
+}
+
 #ifdef _SDL_TTF_H
 bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColor )
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -135,8 +285,16 @@ void LTexture::free()
 {
 	if( mTexture != NULL )
 	{
-		SDL_DestroyTexture( mTexture );
+		if( mShared )
+		{
+			gTextureCache.release( mTexture );
+		}
+		else
+		{
+			SDL_DestroyTexture( mTexture );
+		}
 		mTexture = NULL;
+		mShared = false;
 		mWidth = 0;
 		mHeight = 0;
 	}
@@ -180,6 +338,540 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
+LTextureCache::LTextureCache()
+{
+	mEntryCount = 0;
+
+	mBytes = 0;
+	mBudget = 0;
+
+	mHits = 0;
+	mMisses = 0;
+	mClock = 0;
+}
+
+LTextureCache::~LTextureCache()
+{
+	free();
+}
+
+SDL_Texture* LTextureCache::acquire( std::string path, bool colorKey, SDL_TextureAccess access, SDL_Surface* surface, int& width, int& height )
+{
+	int index = find( path, colorKey, access );
+	if( index >= 0 )
+	{
+		LCachedTexture& entry = mEntries[ index ];
+		++entry.references;
+		entry.lastUsed = ++mClock;
+		++mHits;
+
+		width = entry.width;
+		height = entry.height;
+		return entry.texture;
+	}
+
+	++mMisses;
+
+	evict( 1 );
+	if( mEntryCount == MAX_CACHED_TEXTURES )
+	{
+		printf( "Unable to cache %s! Texture cache is full!\n", path.c_str() );
+		return NULL;
+	}
+
+	SDL_Surface* loadedSurface = surface;
+	if( loadedSurface == NULL )
+	{
+		loadedSurface = IMG_Load( path.c_str() );
+		if( loadedSurface == NULL )
+		{
+			printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+			return NULL;
+		}
+
+		if( colorKey )
+		{
+			SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+		}
+	}
+
+	SDL_Texture* newTexture = NULL;
+	if( access == SDL_TEXTUREACCESS_STATIC && surface == NULL )
+	{
+		newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
+	}
+	else
+	{
+		newTexture = SDL_CreateTexture( gRenderer, loadedSurface->format->format, access, loadedSurface->w, loadedSurface->h );
+		if( newTexture != NULL && SDL_UpdateTexture( newTexture, NULL, loadedSurface->pixels, loadedSurface->pitch ) != 0 )
+		{
+			SDL_DestroyTexture( newTexture );
+			newTexture = NULL;
+		}
+	}
+
+	if( newTexture == NULL )
+	{
+		printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+	}
+	else
+	{
+		SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
+
+		LCachedTexture& entry = mEntries[ mEntryCount ];
+		entry.path = path;
+		entry.colorKey = colorKey;
+		entry.access = access;
+		entry.texture = newTexture;
+		entry.width = loadedSurface->w;
+		entry.height = loadedSurface->h;
+		entry.bytes = loadedSurface->w * loadedSurface->h * 4;
+		entry.references = 1;
+		entry.lastUsed = ++mClock;
+		++mEntryCount;
+
+		mBytes += entry.bytes;
+
+		width = entry.width;
+		height = entry.height;
+	}
+
+	if( loadedSurface != surface )
+	{
+		SDL_FreeSurface( loadedSurface );
+	}
+
+	return newTexture;
+}
+
+void LTextureCache::release( SDL_Texture* texture )
+{
+	for( int i = 0; i < mEntryCount; ++i )
+	{
+		if( mEntries[ i ].texture == texture )
+		{
+			--mEntries[ i ].references;
+			mEntries[ i ].lastUsed = ++mClock;
+			break;
+		}
+	}
+
+	evict( 0 );
+}
+
+bool LTextureCache::contains( std::string path, bool colorKey, SDL_TextureAccess access )
+{
+	return find( path, colorKey, access ) >= 0;
+}
+
+void LTextureCache::setBudget( int bytes )
+{
+	mBudget = bytes;
+
+	evict( 0 );
+}
+
+void LTextureCache::free()
+{
+	for( int i = 0; i < mEntryCount; ++i )
+	{
+		SDL_DestroyTexture( mEntries[ i ].texture );
+		mEntries[ i ].texture = NULL;
+	}
+	mEntryCount = 0;
+	mBytes = 0;
+}
+
+int LTextureCache::getHits()
+{
+	return mHits;
+}
+
+int LTextureCache::getMisses()
+{
+	return mMisses;
+}
+
+int LTextureCache::getBytes()
+{
+	return mBytes;
+}
+
+int LTextureCache::find( std::string path, bool colorKey, SDL_TextureAccess access )
+{
+	for( int i = 0; i < mEntryCount; ++i )
+	{
+		if( mEntries[ i ].colorKey == colorKey && mEntries[ i ].access == access && mEntries[ i ].path == path )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void LTextureCache::evict( int slotsNeeded )
+{
+	while( mBytes > mBudget || mEntryCount + slotsNeeded > MAX_CACHED_TEXTURES )
+	{
+		int oldest = -1;
+		for( int i = 0; i < mEntryCount; ++i )
+		{
+			if( mEntries[ i ].references == 0 && ( oldest < 0 || mEntries[ i ].lastUsed < mEntries[ oldest ].lastUsed ) )
+			{
+				oldest = i;
+			}
+		}
+
+		if( oldest < 0 )
+		{
+			break;
+		}
+
+		SDL_DestroyTexture( mEntries[ oldest ].texture );
+		mBytes -= mEntries[ oldest ].bytes;
+
+		--mEntryCount;
+		mEntries[ oldest ] = mEntries[ mEntryCount ];
+		mEntries[ mEntryCount ].texture = NULL;
+	}
+}
+
+LTextureLoader::LTextureLoader()
+{
+	mRequestCount = 0;
+	mNextPending = 0;
+	mCompleted = 0;
+
+	mThreadCount = 0;
+
+	mLock = NULL;
+	mPending = NULL;
+	mQuit = false;
+
+	mProgressCallback = NULL;
+	mProgressData = NULL;
+}
+
+LTextureLoader::~LTextureLoader()
+{
+	free();
+}
+
+bool LTextureLoader::start( int threadCount )
+{
+	free();
+
+	mLock = SDL_CreateMutex();
+	mPending = SDL_CreateCond();
+	if( mLock == NULL || mPending == NULL )
+	{
+		printf( "Unable to create loader lock! SDL Error: %s\n", SDL_GetError() );
+		free();
+		return false;
+	}
+
+	if( threadCount > MAX_LOADER_THREADS )
+	{
+		threadCount = MAX_LOADER_THREADS;
+	}
+
+	mQuit = false;
+	for( int i = 0; i < threadCount; ++i )
+	{
+		mThreads[ mThreadCount ] = SDL_CreateThread( workerThread, "TextureLoader", this );
+		if( mThreads[ mThreadCount ] == NULL )
+		{
+			printf( "Unable to create loader thread! SDL Error: %s\n", SDL_GetError() );
+			break;
+		}
+
+		++mThreadCount;
+	}
+
+	if( mThreadCount == 0 )
+	{
+		free();
+		return false;
+	}
+
+	return true;
+}
+
+void LTextureLoader::free()
+{
+	if( mLock != NULL )
+	{
+		SDL_LockMutex( mLock );
+		mQuit = true;
+		SDL_CondBroadcast( mPending );
+		SDL_UnlockMutex( mLock );
+	}
+
+	for( int i = 0; i < mThreadCount; ++i )
+	{
+		SDL_WaitThread( mThreads[ i ], NULL );
+	}
+	mThreadCount = 0;
+
+	for( int i = 0; i < mRequestCount; ++i )
+	{
+		if( mRequests[ i ].surface != NULL )
+		{
+			SDL_FreeSurface( mRequests[ i ].surface );
+			mRequests[ i ].surface = NULL;
+		}
+	}
+	mRequestCount = 0;
+	mNextPending = 0;
+	mCompleted = 0;
+
+	if( mPending != NULL )
+	{
+		SDL_DestroyCond( mPending );
+		mPending = NULL;
+	}
+
+	if( mLock != NULL )
+	{
+		SDL_DestroyMutex( mLock );
+		mLock = NULL;
+	}
+}
+
+int LTextureLoader::request( std::string path, LTexture& texture )
+{
+	if( mLock == NULL || mRequestCount == MAX_LOAD_REQUESTS )
+	{
+		printf( "Unable to queue %s for loading!\n", path.c_str() );
+		return -1;
+	}
+
+	SDL_LockMutex( mLock );
+
+	int handle = mRequestCount;
+
+	LLoadRequest& loadRequest = mRequests[ handle ];
+	loadRequest.path = path;
+	loadRequest.texture = &texture;
+	loadRequest.surface = NULL;
+	loadRequest.state = LOAD_STATE_PENDING;
+	loadRequest.original = -1;
+
+	bool cached = gTextureCache.contains( path, true, SDL_TEXTUREACCESS_STATIC );
+	if( cached )
+	{
+		loadRequest.state = texture.loadShared( path ) ? LOAD_STATE_LOADED : LOAD_STATE_FAILED;
+		++mCompleted;
+	}
+	else
+	{
+		for( int i = 0; i < mRequestCount; ++i )
+		{
+			if( mRequests[ i ].original < 0 && mRequests[ i ].state < LOAD_STATE_LOADED && mRequests[ i ].path == path )
+			{
+				loadRequest.state = LOAD_STATE_DUPLICATE;
+				loadRequest.original = i;
+				break;
+			}
+		}
+	}
+
+	++mRequestCount;
+
+	SDL_CondSignal( mPending );
+	SDL_UnlockMutex( mLock );
+
+	if( cached && mProgressCallback != NULL )
+	{
+		mProgressCallback( mCompleted, mRequestCount, mProgressData );
+	}
+
+	return handle;
+}
+
+int LTextureLoader::upload()
+{
+	if( mLock == NULL )
+	{
+		return 0;
+	}
+
+	int ready[ MAX_LOAD_REQUESTS ];
+	int readyCount = 0;
+
+	SDL_LockMutex( mLock );
+	for( int i = 0; i < mRequestCount; ++i )
+	{
+		LLoadState state = mRequests[ i ].state;
+		if( state == LOAD_STATE_DUPLICATE )
+		{
+			state = mRequests[ mRequests[ i ].original ].state;
+		}
+
+		if( state == LOAD_STATE_DECODED || state == LOAD_STATE_DECODE_FAILED )
+		{
+			ready[ readyCount ] = i;
+			++readyCount;
+		}
+	}
+	SDL_UnlockMutex( mLock );
+
+	for( int i = 0; i < readyCount; ++i )
+	{
+		LLoadRequest& loadRequest = mRequests[ ready[ i ] ];
+
+		bool loaded = false;
+		if( loadRequest.state == LOAD_STATE_DUPLICATE )
+		{
+			loaded = mRequests[ loadRequest.original ].state == LOAD_STATE_LOADED && loadRequest.texture->loadShared( loadRequest.path );
+		}
+		else if( loadRequest.state == LOAD_STATE_DECODED )
+		{
+			loaded = loadRequest.texture->loadShared( loadRequest.path, loadRequest.surface );
+		}
+
+		SDL_LockMutex( mLock );
+		loadRequest.state = loaded ? LOAD_STATE_LOADED : LOAD_STATE_FAILED;
+		SDL_UnlockMutex( mLock );
+
+		if( loadRequest.surface != NULL )
+		{
+			SDL_FreeSurface( loadRequest.surface );
+			loadRequest.surface = NULL;
+		}
+
+		++mCompleted;
+
+		if( mProgressCallback != NULL )
+		{
+			mProgressCallback( mCompleted, mRequestCount, mProgressData );
+		}
+	}
+
+	return readyCount;
+}
+
+void LTextureLoader::setProgressCallback( LLoadProgressCallback callback, void* data )
+{
+	mProgressCallback = callback;
+	mProgressData = data;
+}
+
+bool LTextureLoader::isReady( int handle )
+{
+	if( mLock == NULL || handle < 0 || handle >= mRequestCount )
+	{
+		return false;
+	}
+
+	SDL_LockMutex( mLock );
+	LLoadState state = mRequests[ handle ].state;
+	SDL_UnlockMutex( mLock );
+
+	return state == LOAD_STATE_LOADED || state == LOAD_STATE_FAILED;
+}
+
+bool LTextureLoader::isLoaded( int handle )
+{
+	if( mLock == NULL || handle < 0 || handle >= mRequestCount )
+	{
+		return false;
+	}
+
+	SDL_LockMutex( mLock );
+	LLoadState state = mRequests[ handle ].state;
+	SDL_UnlockMutex( mLock );
+
+	return state == LOAD_STATE_LOADED;
+}
+
+bool LTextureLoader::isFinished()
+{
+	return mCompleted == mRequestCount;
+}
+
+int LTextureLoader::getCompleted()
+{
+	return mCompleted;
+}
+
+int LTextureLoader::getTotal()
+{
+	return mRequestCount;
+}
+
+int LTextureLoader::workerThread( void* data )
+{
+	( (LTextureLoader*)data )->work();
+
+	return 0;
+}
+
+SDL_Surface* LTextureLoader::decode( std::string path )
+{
+	SDL_Surface* formattedSurface = NULL;
+
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+	}
+	else
+	{
+		SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+		formattedSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
+		if( formattedSurface == NULL )
+		{
+			printf( "Unable to convert loaded surface %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+		}
+
+		SDL_FreeSurface( loadedSurface );
+	}
+
+	return formattedSurface;
+}
+
+void LTextureLoader::work()
+{
+	SDL_LockMutex( mLock );
+
+	while( true )
+	{
+		while( !mQuit && mNextPending == mRequestCount )
+		{
+			SDL_CondWait( mPending, mLock );
+		}
+
+		if( mQuit )
+		{
+			break;
+		}
+
+		LLoadRequest& loadRequest = mRequests[ mNextPending ];
+		++mNextPending;
+
+		if( loadRequest.state != LOAD_STATE_PENDING )
+		{
+			continue;
+		}
+
+		loadRequest.state = LOAD_STATE_DECODING;
+
+		std::string path = loadRequest.path;
+
+		SDL_UnlockMutex( mLock );
+		SDL_Surface* surface = decode( path );
+		SDL_LockMutex( mLock );
+
+		loadRequest.surface = surface;
+		loadRequest.state = surface != NULL ? LOAD_STATE_DECODED : LOAD_STATE_DECODE_FAILED;
+	}
+
+	SDL_UnlockMutex( mLock );
+}
+
 bool init()
 {
 	bool success = true;
@@ -231,39 +923,66 @@ bool loadMedia()
 {
 	bool success = true;
 
-	if( !gPressTexture.loadFromFile( "18_key_states/press.png" ) )
-	{
-		printf( "Failed to load press texture!\n" );
-		success = false;
-	}
-	
-	if( !gUpTexture.loadFromFile( "18_key_states/up.png" ) )
+	gTextureCache.setBudget( TEXTURE_CACHE_BUDGET );
+
+	if( !gTextureLoader.start( SDL_GetCPUCount() ) )
 	{
-		printf( "Failed to load up texture!\n" );
-		success = false;
+		printf( "Failed to start texture loader!\n" );
+		return false;
 	}
 
-	if( !gDownTexture.loadFromFile( "18_key_states/down.png" ) )
+	gTextureLoader.setProgressCallback( renderLoadingScreen, NULL );
+
+	LTexture* textures[] = { &gPressTexture, &gUpTexture, &gDownTexture, &gLeftTexture, &gRightTexture };
+	std::string names[] = { "press", "up", "down", "left", "right" };
+	int handles[ TOTAL_KEY_TEXTURES ];
+
+	for( int i = 0; i < TOTAL_KEY_TEXTURES; ++i )
 	{
-		printf( "Failed to load down texture!\n" );
-		success = false;
+		handles[ i ] = gTextureLoader.request( "18_key_states/" + names[ i ] + ".png", *textures[ i ] );
 	}
 
-	if( !gLeftTexture.loadFromFile( "18_key_states/left.png" ) )
+	renderLoadingScreen( 0, gTextureLoader.getTotal(), NULL );
+
+	while( !gTextureLoader.isFinished() )
 	{
-		printf( "Failed to load left texture!\n" );
-		success = false;
+		if( gTextureLoader.upload() == 0 )
+		{
+			SDL_Delay( 1 );
+		}
 	}
 
-	if( !gRightTexture.loadFromFile( "18_key_states/right.png" ) )
+	for( int i = 0; i < TOTAL_KEY_TEXTURES; ++i )
 	{
-		printf( "Failed to load right texture!\n" );
-		success = false;
+		if( !gTextureLoader.isLoaded( handles[ i ] ) )
+		{
+			printf( "Failed to load %s texture!\n", names[ i ].c_str() );
+			success = false;
+		}
 	}
 
+	gTextureLoader.free();
+
 	return success;
 }
 
+void renderLoadingScreen( int completed, int total, void* data )
+{
+	SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+	SDL_RenderClear( gRenderer );
+
+	SDL_Rect outline = { SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 10, SCREEN_WIDTH / 2, 20 };
+	SDL_Rect fill = { outline.x, outline.y, total > 0 ? outline.w * completed / total : 0, outline.h };
+
+	SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0xFF, 0xFF );
+	SDL_RenderFillRect( gRenderer, &fill );
+
+	SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+	SDL_RenderDrawRect( gRenderer, &outline );
+
+	SDL_RenderPresent( gRenderer );
+}
+
 void close()
 {
 	gPressTexture.free();
@@ -272,6 +991,9 @@ void close()
 	gLeftTexture.free();
 	gRightTexture.free();
 
+	printf( "Texture cache: %d hits, %d misses, %d bytes resident\n", gTextureCache.getHits(), gTextureCache.getMisses(), gTextureCache.getBytes() );
+	gTextureCache.free();
+
 	SDL_DestroyRenderer( gRenderer );
 	SDL_DestroyWindow( gWindow );
 	gWindow = NULL;
@@ -105,7 +105,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
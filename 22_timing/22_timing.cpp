@@ -8,6 +8,12 @@
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int FIRST_ATLAS_GLYPH = 32;
+const int TOTAL_ATLAS_GLYPHS = 95;
+const int ATLAS_WIDTH = 512;
+const int ATLAS_GLYPH_PADDING = 1;
+const int MAX_TEXT_GLYPHS = 256;
+
 class LTexture
 {
 	public:
@@ -41,6 +47,41 @@ class LTexture
 		int mHeight;
 };
 
+class LGlyphAtlas
+{
+	public:
+		LGlyphAtlas();
+
+		~LGlyphAtlas();
+
+		bool loadFromFont( TTF_Font* font );
+
+		void free();
+
+		void renderText( int x, int y, std::string text, SDL_Color color );
+
+		int getTextWidth( std::string text );
+		int getLineHeight();
+
+	private:
+		void flush();
+
+		SDL_Texture* mTexture;
+		int mWidth;
+		int mHeight;
+
+		TTF_Font* mFont;
+		int mLineHeight;
+
+		SDL_Rect mGlyphClips[ TOTAL_ATLAS_GLYPHS ];
+		int mGlyphAdvances[ TOTAL_ATLAS_GLYPHS ];
+		bool mGlyphLoaded[ TOTAL_ATLAS_GLYPHS ];
+
+		SDL_Vertex mVertices[ MAX_TEXT_GLYPHS * 4 ];
+		int mIndices[ MAX_TEXT_GLYPHS * 6 ];
+		int mGlyphCount;
+};
+
 bool init();
 
 bool loadMedia();
@@ -53,9 +94,10 @@ SDL_Renderer* gRenderer = NULL;
 
 TTF_Font *gFont = NULL;
 
-LTexture gTimeTextTexture;
 LTexture gPromptTextTexture;
 
+LGlyphAtlas gTextAtlas;
+
 LTexture::LTexture()
 {
 	mTexture = NULL;
@@ -106,7 +148,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -181,6 +223,243 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
+LGlyphAtlas::LGlyphAtlas()
+{
+	mTexture = NULL;
+	mWidth = 0;
+	mHeight = 0;
+
+	mFont = NULL;
+	mLineHeight = 0;
+
+	for( int i = 0; i < TOTAL_ATLAS_GLYPHS; ++i )
+	{
+		mGlyphAdvances[ i ] = 0;
+		mGlyphLoaded[ i ] = false;
+	}
+
+	for( int i = 0; i < MAX_TEXT_GLYPHS; ++i )
+	{
+		mIndices[ i * 6 + 0 ] = i * 4 + 0;
+		mIndices[ i * 6 + 1 ] = i * 4 + 1;
+		mIndices[ i * 6 + 2 ] = i * 4 + 2;
+		mIndices[ i * 6 + 3 ] = i * 4 + 2;
+		mIndices[ i * 6 + 4 ] = i * 4 + 3;
+		mIndices[ i * 6 + 5 ] = i * 4 + 0;
+	}
+	mGlyphCount = 0;
+}
+
+LGlyphAtlas::~LGlyphAtlas()
+{
+	free();
+}
+
+bool LGlyphAtlas::loadFromFont( TTF_Font* font )
+{
+	free();
+
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* glyphSurfaces[ TOTAL_ATLAS_GLYPHS ];
+
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+
+	for( int i = 0; i < TOTAL_ATLAS_GLYPHS; ++i )
+	{
+		Uint16 glyph = (Uint16)( FIRST_ATLAS_GLYPH + i );
+
+		int minX, maxX, minY, maxY, advance;
+		glyphSurfaces[ i ] = NULL;
+		if( TTF_GlyphMetrics( font, glyph, &minX, &maxX, &minY, &maxY, &advance ) == 0 )
+		{
+			glyphSurfaces[ i ] = TTF_RenderGlyph_Solid( font, glyph, white );
+		}
+
+		if( glyphSurfaces[ i ] == NULL )
+		{
+			continue;
+		}
+
+		if( x + glyphSurfaces[ i ]->w > ATLAS_WIDTH )
+		{
+			x = 0;
+			y += shelfHeight + ATLAS_GLYPH_PADDING;
+			shelfHeight = 0;
+		}
+
+		mGlyphClips[ i ].x = x;
+		mGlyphClips[ i ].y = y;
+		mGlyphClips[ i ].w = glyphSurfaces[ i ]->w;
+		mGlyphClips[ i ].h = glyphSurfaces[ i ]->h;
+		mGlyphAdvances[ i ] = advance;
+		mGlyphLoaded[ i ] = true;
+
+		x += glyphSurfaces[ i ]->w + ATLAS_GLYPH_PADDING;
+		shelfHeight = SDL_max( shelfHeight, glyphSurfaces[ i ]->h );
+	}
+
+	SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat( 0, ATLAS_WIDTH, y + shelfHeight, 32, SDL_PIXELFORMAT_RGBA8888 );
+	if( atlasSurface == NULL )
+	{
+		printf( "Unable to create glyph atlas surface! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		SDL_FillRect( atlasSurface, NULL, SDL_MapRGBA( atlasSurface->format, 0xFF, 0xFF, 0xFF, 0x00 ) );
+
+		for( int i = 0; i < TOTAL_ATLAS_GLYPHS; ++i )
+		{
+			if( glyphSurfaces[ i ] != NULL )
+			{
+				SDL_BlitSurface( glyphSurfaces[ i ], NULL, atlasSurface, &mGlyphClips[ i ] );
+			}
+		}
+
+		mTexture = SDL_CreateTextureFromSurface( gRenderer, atlasSurface );
+		if( mTexture == NULL )
+		{
+			printf( "Unable to create glyph atlas texture! SDL Error: %s\n", SDL_GetError() );
+		}
+		else
+		{
+			SDL_SetTextureBlendMode( mTexture, SDL_BLENDMODE_BLEND );
+
+			mWidth = atlasSurface->w;
+			mHeight = atlasSurface->h;
+			mFont = font;
+			mLineHeight = TTF_FontHeight( font );
+		}
+
+		SDL_FreeSurface( atlasSurface );
+	}
+
+	for( int i = 0; i < TOTAL_ATLAS_GLYPHS; ++i )
+	{
+		SDL_FreeSurface( glyphSurfaces[ i ] );
+	}
+
+	return mTexture != NULL;
+}
+
+void LGlyphAtlas::free()
+{
+	if( mTexture != NULL )
+	{
+		SDL_DestroyTexture( mTexture );
+		mTexture = NULL;
+		mWidth = 0;
+		mHeight = 0;
+	}
+
+	for( int i = 0; i < TOTAL_ATLAS_GLYPHS; ++i )
+	{
+		mGlyphLoaded[ i ] = false;
+	}
+
+	mFont = NULL;
+	mLineHeight = 0;
+	mGlyphCount = 0;
+}
+
+void LGlyphAtlas::renderText( int x, int y, std::string text, SDL_Color color )
+{
+	if( mTexture == NULL )
+	{
+		return;
+	}
+
+	int penX = x;
+	int previous = -1;
+
+	for( size_t i = 0; i < text.length(); ++i )
+	{
+		int glyph = (unsigned char)text[ i ] - FIRST_ATLAS_GLYPH;
+		if( ( glyph < 0 ) || ( glyph >= TOTAL_ATLAS_GLYPHS ) || !mGlyphLoaded[ glyph ] )
+		{
+			previous = -1;
+			continue;
+		}
+
+		if( previous >= 0 )
+		{
+			penX += TTF_GetFontKerningSizeGlyphs( mFont, (Uint16)( FIRST_ATLAS_GLYPH + previous ), (Uint16)( FIRST_ATLAS_GLYPH + glyph ) );
+		}
+
+		if( mGlyphCount == MAX_TEXT_GLYPHS )
+		{
+			flush();
+		}
+
+		SDL_Rect& clip = mGlyphClips[ glyph ];
+
+		float u0 = (float)clip.x / mWidth;
+		float v0 = (float)clip.y / mHeight;
+		float u1 = (float)( clip.x + clip.w ) / mWidth;
+		float v1 = (float)( clip.y + clip.h ) / mHeight;
+
+		SDL_Vertex* vertices = &mVertices[ mGlyphCount * 4 ];
+		SDL_Vertex quad[ 4 ] =
+		{
+			{ { (float)penX, (float)y }, color, { u0, v0 } },
+			{ { (float)( penX + clip.w ), (float)y }, color, { u1, v0 } },
+			{ { (float)( penX + clip.w ), (float)( y + clip.h ) }, color, { u1, v1 } },
+			{ { (float)penX, (float)( y + clip.h ) }, color, { u0, v1 } }
+		};
+		for( int j = 0; j < 4; ++j )
+		{
+			vertices[ j ] = quad[ j ];
+		}
+		++mGlyphCount;
+
+		penX += mGlyphAdvances[ glyph ];
+		previous = glyph;
+	}
+
+	flush();
+}
+
+int LGlyphAtlas::getTextWidth( std::string text )
+{
+	int width = 0;
+	int previous = -1;
+
+	for( size_t i = 0; i < text.length(); ++i )
+	{
+		int glyph = (unsigned char)text[ i ] - FIRST_ATLAS_GLYPH;
+		if( ( glyph < 0 ) || ( glyph >= TOTAL_ATLAS_GLYPHS ) || !mGlyphLoaded[ glyph ] )
+		{
+			previous = -1;
+			continue;
+		}
+
+		if( previous >= 0 )
+		{
+			width += TTF_GetFontKerningSizeGlyphs( mFont, (Uint16)( FIRST_ATLAS_GLYPH + previous ), (Uint16)( FIRST_ATLAS_GLYPH + glyph ) );
+		}
+
+		width += mGlyphAdvances[ glyph ];
+		previous = glyph;
+	}
+
+	return width;
+}
+
+int LGlyphAtlas::getLineHeight()
+{
+	return mLineHeight;
+}
+
+void LGlyphAtlas::flush()
+{
+	if( mGlyphCount > 0 )
+	{
+		SDL_RenderGeometry( gRenderer, mTexture, mVertices, mGlyphCount * 4, mIndices, mGlyphCount * 6 );
+		mGlyphCount = 0;
+	}
+}
+
 bool init()
 {
 	bool success = true;
@@ -253,6 +532,12 @@ bool loadMedia()
 			printf( "Unable to render prompt texture!\n" );
 			success = false;
 		}
+
+		if( !gTextAtlas.loadFromFont( gFont ) )
+		{
+			printf( "Failed to build glyph atlas!\n" );
+			success = false;
+		}
 	}
 
 	return success;
@@ -260,8 +545,8 @@ bool loadMedia()
 
 void close()
 {
-	gTimeTextTexture.free();
 	gPromptTextTexture.free();
+	gTextAtlas.free();
 
 	TTF_CloseFont( gFont );
 	gFont = NULL;
@@ -317,16 +602,11 @@ int main( int argc, char* args[] )
 				timeText.str( "" );
 				timeText << "Milliseconds since start time " << SDL_GetTicks() - startTime; 
 
-				if( !gTimeTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor ) )
-				{
-					printf( "Unable to render time texture!\n" );
-				}
-
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
 				gPromptTextTexture.render( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, 0 );
-				gTimeTextTexture.render( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gPromptTextTexture.getHeight() ) / 2 );
+				gTextAtlas.renderText( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gPromptTextTexture.getHeight() ) / 2, timeText.str(), textColor );
 
 				SDL_RenderPresent( gRenderer );
 			}
@@ -3,13 +3,16 @@
 #include <SDL_ttf.h>
 #include <stdio.h>
 #include <string>
-#include <sstream>
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 const int SCREEN_FPS = 60;
 const int SCREEN_TICK_PER_FRAME = 1000 / SCREEN_FPS;
 
+const int TOTAL_OVERLAY_GLYPHS = 11;
+const int MAX_OVERLAY_DECIMALS = 3;
+const int MAX_OVERLAY_CHARACTERS = 16;
+
 class LTexture
 {
 	public:
@@ -43,6 +46,40 @@ class LTexture
 		int mHeight;
 };
 
+class LStatsOverlay
+{
+	public:
+		LStatsOverlay();
+
+		bool loadFromRenderedText( std::string label, SDL_Color textColor );
+
+		void free();
+
+		void setValue( float value, int decimals );
+
+		void render( int x, int y );
+
+		int getWidth();
+		int getHeight();
+
+	private:
+		int formatValue( float value, int decimals, char* text );
+
+		LTexture mLabelTexture;
+		LTexture mGlyphTexture;
+
+		SDL_Rect mGlyphClips[ TOTAL_OVERLAY_GLYPHS ];
+
+		char mText[ MAX_OVERLAY_CHARACTERS ];
+		int mTextLength;
+
+		int mGlyphs[ MAX_OVERLAY_CHARACTERS ];
+		int mGlyphX[ MAX_OVERLAY_CHARACTERS ];
+
+		int mWidth;
+		int mHeight;
+};
+
 class LTimer
 {
     public:
@@ -79,7 +116,7 @@ SDL_Renderer* gRenderer = NULL;
 
 TTF_Font* gFont = NULL;
 
-LTexture gFPSTextTexture;
+LStatsOverlay gFPSOverlay;
 
 LTexture::LTexture()
 {
@@ -131,7 +168,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -206,6 +243,189 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
+LStatsOverlay::LStatsOverlay()
+{
+	mTextLength = 0;
+	mWidth = 0;
+	mHeight = 0;
+}
+
+bool LStatsOverlay::loadFromRenderedText( std::string label, SDL_Color textColor )
+{
+	free();
+
+	const char* glyphs = "0123456789.";
+
+	bool success = true;
+
+	if( !mLabelTexture.loadFromRenderedText( label, textColor ) )
+	{
+		printf( "Failed to render overlay label!\n" );
+		success = false;
+	}
+	else if( !mGlyphTexture.loadFromRenderedText( glyphs, textColor ) )
+	{
+		printf( "Failed to render overlay glyphs!\n" );
+		success = false;
+	}
+	else
+	{
+		char prefix[ TOTAL_OVERLAY_GLYPHS + 1 ];
+		int left = 0;
+		for( int i = 0; i < TOTAL_OVERLAY_GLYPHS; ++i )
+		{
+			prefix[ i ] = glyphs[ i ];
+			prefix[ i + 1 ] = '\0';
+
+			int right = 0;
+			TTF_SizeText( gFont, prefix, &right, NULL );
+
+			mGlyphClips[ i ].x = left;
+			mGlyphClips[ i ].y = 0;
+			mGlyphClips[ i ].w = right - left;
+			mGlyphClips[ i ].h = mGlyphTexture.getHeight();
+
+			left = right;
+		}
+
+		mWidth = mLabelTexture.getWidth();
+		mHeight = mLabelTexture.getHeight() > mGlyphTexture.getHeight() ? mLabelTexture.getHeight() : mGlyphTexture.getHeight();
+	}
+
+	return success;
+}
+
+void LStatsOverlay::free()
+{
+	mLabelTexture.free();
+	mGlyphTexture.free();
+
+	mTextLength = 0;
+	mWidth = 0;
+	mHeight = 0;
+}
+
+void LStatsOverlay::setValue( float value, int decimals )
+{
+	char text[ MAX_OVERLAY_CHARACTERS ];
+	int length = formatValue( value, decimals, text );
+
+	if( length == mTextLength && memcmp( text, mText, length ) == 0 )
+	{
+		return;
+	}
+
+	memcpy( mText, text, length );
+	mTextLength = length;
+
+	int x = mLabelTexture.getWidth();
+	for( int i = 0; i < mTextLength; ++i )
+	{
+		int glyph = 0;
+		if( mText[ i ] == '.' )
+		{
+			glyph = 10;
+		}
+		else
+		{
+			glyph = mText[ i ] - '0';
+		}
+
+		mGlyphs[ i ] = glyph;
+		mGlyphX[ i ] = x;
+		x += mGlyphClips[ glyph ].w;
+	}
+
+	mWidth = x;
+}
+
+void LStatsOverlay::render( int x, int y )
+{
+	mLabelTexture.render( x, y );
+
+	for( int i = 0; i < mTextLength; ++i )
+	{
+		mGlyphTexture.render( x + mGlyphX[ i ], y, &mGlyphClips[ mGlyphs[ i ] ] );
+	}
+}
+
+int LStatsOverlay::getWidth()
+{
+	return mWidth;
+}
+
+int LStatsOverlay::getHeight()
+{
+	return mHeight;
+}
+
+int LStatsOverlay::formatValue( float value, int decimals, char* text )
+{
+	if( decimals < 0 )
+	{
+		decimals = 0;
+	}
+	if( decimals > MAX_OVERLAY_DECIMALS )
+	{
+		decimals = MAX_OVERLAY_DECIMALS;
+	}
+
+	int length = 0;
+	if( value != value || value < 0 || value > 4e9f )
+	{
+		text[ length ] = '0';
+		++length;
+		return length;
+	}
+
+	Uint32 scale = 1;
+	for( int i = 0; i < decimals; ++i )
+	{
+		scale *= 10;
+	}
+
+	double scaled = (double)value * scale + 0.5;
+	if( scaled > 4000000000.0 )
+	{
+		scaled = 4000000000.0;
+	}
+
+	Uint32 fixed = (Uint32)scaled;
+	Uint32 whole = fixed / scale;
+	Uint32 fraction = fixed % scale;
+
+	char digits[ 10 ];
+	int digitCount = 0;
+	do
+	{
+		digits[ digitCount ] = '0' + whole % 10;
+		++digitCount;
+		whole /= 10;
+	}
+	while( whole > 0 );
+
+	while( digitCount > 0 )
+	{
+		--digitCount;
+		text[ length ] = digits[ digitCount ];
+		++length;
+	}
+
+	if( decimals > 0 )
+	{
+		text[ length ] = '.';
+		++length;
+
+		for( Uint32 divisor = scale / 10; divisor > 0; divisor /= 10 )
+		{
+			text[ length ] = '0' + ( fraction / divisor ) % 10;
+			++length;
+		}
+	}
+
+	return length;
+}
+
 LTimer::LTimer()
 {
     mStartTicks = 0;
@@ -350,13 +570,22 @@ bool loadMedia()
 		printf( "Failed to load lazy font! SDL_ttf Error: %s\n", TTF_GetError() );
 		success = false;
 	}
+	else
+	{
+		SDL_Color textColor = { 0, 0, 0, 255 };
+		if( !gFPSOverlay.loadFromRenderedText( "Average Frames Per Second (With Cap) ", textColor ) )
+		{
+			printf( "Failed to render FPS overlay!\n" );
+			success = false;
+		}
+	}
 
 	return success;
 }
 
 void close()
 {
-	gFPSTextTexture.free();
+	gFPSOverlay.free();
 
 	TTF_CloseFont( gFont );
 	gFont = NULL;
@@ -389,14 +618,10 @@ int main( int argc, char* args[] )
 
 			SDL_Event e;
 
-			SDL_Color textColor = { 0, 0, 0, 255 };
-
 			LTimer fpsTimer;
 
 			LTimer capTimer;
 
-			std::stringstream timeText;
-
 			int countedFrames = 0;
 			fpsTimer.start();
 
@@ -412,24 +637,23 @@ int main( int argc, char* args[] )
 					}
 				}
 
-				float avgFPS = countedFrames / ( fpsTimer.getTicks() / 1000.f );
+				float avgFPS = 0;
+				Uint32 fpsTicks = fpsTimer.getTicks();
+				if( fpsTicks > 0 )
+				{
+					avgFPS = countedFrames / ( fpsTicks / 1000.f );
+				}
 				if( avgFPS > 2000000 )
 				{
 					avgFPS = 0;
 				}
 
-				timeText.str( "" );
-				timeText << "Average Frames Per Second (With Cap) " << avgFPS; 
-
-				if( !gFPSTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor ) )
-				{
-					printf( "Unable to render FPS texture!\n" );
-				}
+				gFPSOverlay.setValue( avgFPS, 2 );
 
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
-				gFPSTextTexture.render( ( SCREEN_WIDTH - gFPSTextTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gFPSTextTexture.getHeight() ) / 2 );
+				gFPSOverlay.render( ( SCREEN_WIDTH - gFPSOverlay.getWidth() ) / 2, ( SCREEN_HEIGHT - gFPSOverlay.getHeight() ) / 2 );
 
 				SDL_RenderPresent( gRenderer );
 				++countedFrames;
@@ -4,10 +4,22 @@
 #include <stdio.h>
 #include <string>
 #include <sstream>
+#include <vector>
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int TEXT_MARGIN = 10;
+const int CARET_WIDTH = 2;
+const int MAX_SELECTION_RECTS = 64;
+
+const int ADVANCE_PAGE_SIZE = 256;
+const int TOTAL_ADVANCE_PAGES = 0x10000 / ADVANCE_PAGE_SIZE;
+
+const int BENCHMARK_TEXT_BYTES = 100 * 1024;
+const int BENCHMARK_EDITS = 1000;
+const int BENCHMARK_FULL_EDITS = 20;
+
 class LTexture
 {
 	public:
@@ -41,12 +53,85 @@ class LTexture
 		int mHeight;
 };
 
+struct LTextLine
+{
+	std::string text;
+	std::vector<int> offsets;
+	SDL_Texture* texture;
+	int start;
+	int width;
+	int height;
+	bool hardBreak;
+	bool dirty;
+};
+
+class LTextLayout
+{
+	public:
+		LTextLayout();
+
+		~LTextLayout();
+
+		void setFont( TTF_Font* font, SDL_Color textColor, int wrapWidth );
+
+		void setText( std::string text );
+
+		std::string getText( int start, int end );
+
+		int replace( int start, int end, std::string text );
+
+		int getPreviousOffset( int offset );
+		int getNextOffset( int offset );
+
+		void free();
+
+		int hitTest( int x, int y );
+
+		SDL_Rect getCaretRect( int offset );
+
+		int getSelectionRects( int start, int end, int top, int bottom, SDL_Rect* rects, int maxRects );
+
+		void render( int x, int y, int top, int bottom );
+
+		int getLength();
+		int getLineCount();
+		int getLineHeight();
+
+	private:
+		int findLine( int offset );
+
+		bool findBreak( std::string& text, int position, int& end, int& next, bool& hardBreak, bool lastRun );
+
+		void shapeLine( LTextLine& line );
+
+		void renderLine( LTextLine& line );
+
+		int getAdvance( Uint32 previous, Uint32 glyph );
+
+		void freeAdvances();
+
+		TTF_Font* mFont;
+		SDL_Color mTextColor;
+
+		int mWrapWidth;
+		int mLineHeight;
+		int mLength;
+
+		int* mAdvancePages[ TOTAL_ADVANCE_PAGES ];
+
+		std::vector<LTextLine> mLines;
+};
+
 bool init();
 
 bool loadMedia();
 
 void close();
 
+Uint32 decodeUTF8( std::string& text, int& position );
+
+void benchmarkTextLayout();
+
 SDL_Window* gWindow = NULL;
 
 SDL_Renderer* gRenderer = NULL;
@@ -54,7 +139,7 @@ SDL_Renderer* gRenderer = NULL;
 TTF_Font *gFont = NULL;
 
 LTexture gPromptTextTexture;
-LTexture gInputTextTexture;
+LTextLayout gInputTextLayout;
 
 LTexture::LTexture()
 {
@@ -106,7 +191,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -181,6 +266,602 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
+LTextLayout::LTextLayout()
+{
+	SDL_Color textColor = { 0, 0, 0, 0xFF };
+
+	mFont = NULL;
+	mTextColor = textColor;
+
+	mWrapWidth = 0;
+	mLineHeight = 0;
+	mLength = 0;
+
+	for( int i = 0; i < TOTAL_ADVANCE_PAGES; ++i )
+	{
+		mAdvancePages[ i ] = NULL;
+	}
+}
+
+LTextLayout::~LTextLayout()
+{
+	free();
+	freeAdvances();
+}
+
+void LTextLayout::setFont( TTF_Font* font, SDL_Color textColor, int wrapWidth )
+{
+	free();
+
+	mFont = font;
+	mTextColor = textColor;
+	mWrapWidth = wrapWidth;
+	mLineHeight = TTF_FontLineSkip( font );
+
+	freeAdvances();
+}
+
+void LTextLayout::setText( std::string text )
+{
+	free();
+
+	LTextLine line;
+	line.texture = NULL;
+	line.start = 0;
+	line.width = 0;
+	line.height = 0;
+	line.hardBreak = false;
+	line.dirty = true;
+	shapeLine( line );
+	mLines.push_back( line );
+
+	replace( 0, 0, text );
+}
+
+std::string LTextLayout::getText( int start, int end )
+{
+	std::string text;
+
+	int first = findLine( start );
+	int last = findLine( end );
+	for( int i = first; i <= last; ++i )
+	{
+		text += mLines[ i ].text;
+		if( mLines[ i ].hardBreak )
+		{
+			text += '\n';
+		}
+	}
+
+	return text.substr( start - mLines[ first ].start, end - start );
+}
+
+int LTextLayout::replace( int start, int end, std::string text )
+{
+	if( start > end )
+	{
+		int swap = start;
+		start = end;
+		end = swap;
+	}
+	if( start < 0 )
+	{
+		start = 0;
+	}
+	if( end > mLength )
+	{
+		end = mLength;
+	}
+
+	int first = findLine( start );
+	int edited = findLine( end );
+	int lastLine = mLines.size() - 1;
+
+	if( first > 0 && !mLines[ first - 1 ].hardBreak )
+	{
+		--first;
+		while( first > 0 && !mLines[ first - 1 ].hardBreak && mLines[ first ].text.find( ' ' ) == std::string::npos )
+		{
+			--first;
+		}
+	}
+
+	std::string run = getText( mLines[ first ].start, start ) + text;
+	run += mLines[ edited ].text.substr( end - mLines[ edited ].start );
+	if( mLines[ edited ].hardBreak )
+	{
+		run += '\n';
+	}
+
+	std::vector<LTextLine> lines;
+	int consumed = edited;
+	int consumedStart = -1;
+	int position = 0;
+	bool done = false;
+	while( !done )
+	{
+		int lineEnd = 0;
+		int next = 0;
+		bool hardBreak = false;
+		if( !findBreak( run, position, lineEnd, next, hardBreak, consumed == lastLine ) )
+		{
+			++consumed;
+			consumedStart = run.length();
+			run += mLines[ consumed ].text;
+			if( mLines[ consumed ].hardBreak )
+			{
+				run += '\n';
+			}
+			continue;
+		}
+
+		LTextLine line;
+		line.text = run.substr( position, lineEnd - position );
+		line.texture = NULL;
+		line.start = 0;
+		line.width = 0;
+		line.height = 0;
+		line.hardBreak = hardBreak;
+		line.dirty = true;
+		lines.push_back( line );
+
+		position = next;
+		if( next == (int)run.length() )
+		{
+			if( hardBreak && consumed == lastLine )
+			{
+				line.text = "";
+				line.hardBreak = false;
+				lines.push_back( line );
+			}
+			done = true;
+		}
+		else if( next == consumedStart )
+		{
+			--consumed;
+			done = true;
+		}
+	}
+
+	for( int i = 0; i < (int)lines.size(); ++i )
+	{
+		int old = first + i;
+		if( old <= consumed && mLines[ old ].hardBreak == lines[ i ].hardBreak && mLines[ old ].text == lines[ i ].text )
+		{
+			lines[ i ] = mLines[ old ];
+			mLines[ old ].texture = NULL;
+		}
+		else
+		{
+			shapeLine( lines[ i ] );
+		}
+	}
+
+	for( int i = first; i <= consumed; ++i )
+	{
+		if( mLines[ i ].texture != NULL )
+		{
+			SDL_DestroyTexture( mLines[ i ].texture );
+		}
+	}
+
+	int runStart = mLines[ first ].start;
+	mLines.erase( mLines.begin() + first, mLines.begin() + consumed + 1 );
+	mLines.insert( mLines.begin() + first, lines.begin(), lines.end() );
+
+	mLines[ first ].start = runStart;
+	for( int i = first + 1; i < (int)mLines.size(); ++i )
+	{
+		LTextLine& previous = mLines[ i - 1 ];
+		mLines[ i ].start = previous.start + previous.text.length() + ( previous.hardBreak ? 1 : 0 );
+	}
+
+	mLength += text.length() - ( end - start );
+
+	return start + text.length();
+}
+
+int LTextLayout::getPreviousOffset( int offset )
+{
+	if( offset <= 0 )
+	{
+		return 0;
+	}
+	if( offset > mLength )
+	{
+		return mLength;
+	}
+
+	int line = findLine( offset - 1 );
+	std::string& text = mLines[ line ].text;
+
+	int column = offset - 1 - mLines[ line ].start;
+	while( column > 0 && column < (int)text.length() && ( (Uint8)text[ column ] & 0xC0 ) == 0x80 )
+	{
+		--column;
+	}
+
+	return mLines[ line ].start + column;
+}
+
+int LTextLayout::getNextOffset( int offset )
+{
+	if( offset < 0 )
+	{
+		return 0;
+	}
+	if( offset >= mLength )
+	{
+		return mLength;
+	}
+
+	int line = findLine( offset );
+	std::string& text = mLines[ line ].text;
+
+	int column = offset - mLines[ line ].start;
+	if( column >= (int)text.length() )
+	{
+		return offset + 1;
+	}
+
+	decodeUTF8( text, column );
+	return mLines[ line ].start + column;
+}
+
+void LTextLayout::free()
+{
+	for( int i = 0; i < (int)mLines.size(); ++i )
+	{
+		if( mLines[ i ].texture != NULL )
+		{
+			SDL_DestroyTexture( mLines[ i ].texture );
+			mLines[ i ].texture = NULL;
+		}
+	}
+
+	mLines.clear();
+	mLength = 0;
+}
+
+int LTextLayout::hitTest( int x, int y )
+{
+	int line = y / mLineHeight;
+	if( line < 0 )
+	{
+		line = 0;
+	}
+	if( line > (int)mLines.size() - 1 )
+	{
+		line = mLines.size() - 1;
+	}
+
+	LTextLine& textLine = mLines[ line ];
+
+	int columns = textLine.text.length();
+	if( !textLine.hardBreak && line < (int)mLines.size() - 1 && columns > 0 )
+	{
+		--columns;
+		while( columns > 0 && ( (Uint8)textLine.text[ columns ] & 0xC0 ) == 0x80 )
+		{
+			--columns;
+		}
+	}
+
+	int column = 0;
+	while( column < columns )
+	{
+		int next = column;
+		decodeUTF8( textLine.text, next );
+		if( ( textLine.offsets[ column ] + textLine.offsets[ next ] ) / 2 >= x )
+		{
+			break;
+		}
+		column = next;
+	}
+
+	return textLine.start + column;
+}
+
+SDL_Rect LTextLayout::getCaretRect( int offset )
+{
+	if( offset < 0 )
+	{
+		offset = 0;
+	}
+	if( offset > mLength )
+	{
+		offset = mLength;
+	}
+
+	int line = findLine( offset );
+
+	SDL_Rect caret = { mLines[ line ].offsets[ offset - mLines[ line ].start ], line * mLineHeight, CARET_WIDTH, mLineHeight };
+	return caret;
+}
+
+int LTextLayout::getSelectionRects( int start, int end, int top, int bottom, SDL_Rect* rects, int maxRects )
+{
+	if( start > end )
+	{
+		int swap = start;
+		start = end;
+		end = swap;
+	}
+
+	int first = findLine( start );
+	int last = findLine( end );
+	if( first < top / mLineHeight )
+	{
+		first = top / mLineHeight;
+	}
+	if( last > bottom / mLineHeight )
+	{
+		last = bottom / mLineHeight;
+	}
+
+	int rectCount = 0;
+	for( int i = first; i <= last && rectCount < maxRects; ++i )
+	{
+		LTextLine& line = mLines[ i ];
+		int length = line.text.length();
+
+		int left = 0;
+		if( start > line.start )
+		{
+			left = line.offsets[ start - line.start ];
+		}
+
+		int right = line.offsets[ end - line.start < length ? end - line.start : length ];
+		if( end > line.start + length && line.hardBreak )
+		{
+			right += getAdvance( 0, ' ' );
+		}
+
+		if( right > left )
+		{
+			SDL_Rect selection = { left, i * mLineHeight, right - left, mLineHeight };
+			rects[ rectCount ] = selection;
+			++rectCount;
+		}
+	}
+
+	return rectCount;
+}
+
+void LTextLayout::render( int x, int y, int top, int bottom )
+{
+	int first = top / mLineHeight;
+	int last = bottom / mLineHeight;
+	if( first < 0 )
+	{
+		first = 0;
+	}
+	if( last > (int)mLines.size() - 1 )
+	{
+		last = mLines.size() - 1;
+	}
+
+	for( int i = first; i <= last; ++i )
+	{
+		LTextLine& line = mLines[ i ];
+		if( line.dirty )
+		{
+			renderLine( line );
+		}
+
+		if( line.texture != NULL )
+		{
+			SDL_Rect renderQuad = { x, y + i * mLineHeight, line.width, line.height };
+			SDL_RenderCopy( gRenderer, line.texture, NULL, &renderQuad );
+		}
+	}
+}
+
+int LTextLayout::getLength()
+{
+	return mLength;
+}
+
+int LTextLayout::getLineCount()
+{
+	return mLines.size();
+}
+
+int LTextLayout::getLineHeight()
+{
+	return mLineHeight;
+}
+
+int LTextLayout::findLine( int offset )
+{
+	int low = 0;
+	int high = mLines.size() - 1;
+	while( low < high )
+	{
+		int middle = ( low + high + 1 ) / 2;
+		if( mLines[ middle ].start <= offset )
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	return low;
+}
+
+bool LTextLayout::findBreak( std::string& text, int position, int& end, int& next, bool& hardBreak, bool lastRun )
+{
+	int x = 0;
+	int space = -1;
+	Uint32 previous = 0;
+	for( int i = position; i < (int)text.length(); )
+	{
+		int glyphEnd = i;
+		Uint32 glyph = decodeUTF8( text, glyphEnd );
+		if( glyph == '\n' )
+		{
+			end = i;
+			next = i + 1;
+			hardBreak = true;
+			return true;
+		}
+
+		x += getAdvance( previous, glyph );
+		previous = glyph;
+
+		if( x > mWrapWidth && i > position )
+		{
+			if( glyph == ' ' )
+			{
+				end = glyphEnd;
+			}
+			else if( space >= 0 )
+			{
+				end = space + 1;
+			}
+			else
+			{
+				end = i;
+			}
+			next = end;
+			hardBreak = false;
+			return true;
+		}
+
+		if( glyph == ' ' )
+		{
+			space = i;
+		}
+
+		i = glyphEnd;
+	}
+
+	if( !lastRun )
+	{
+		return false;
+	}
+
+	end = text.length();
+	next = end;
+	hardBreak = false;
+	return true;
+}
+
+void LTextLayout::shapeLine( LTextLine& line )
+{
+	line.offsets.resize( line.text.length() + 1 );
+	line.offsets[ 0 ] = 0;
+
+	int x = 0;
+	Uint32 previous = 0;
+	for( int i = 0; i < (int)line.text.length(); )
+	{
+		int glyphEnd = i;
+		Uint32 glyph = decodeUTF8( line.text, glyphEnd );
+		for( int j = i + 1; j < glyphEnd; ++j )
+		{
+			line.offsets[ j ] = x;
+		}
+
+		x += getAdvance( previous, glyph );
+		previous = glyph;
+		line.offsets[ glyphEnd ] = x;
+
+		i = glyphEnd;
+	}
+}
+
+void LTextLayout::renderLine( LTextLine& line )
+{
+	if( line.texture != NULL )
+	{
+		SDL_DestroyTexture( line.texture );
+		line.texture = NULL;
+	}
+
+	line.width = 0;
+	line.height = 0;
+	line.dirty = false;
+
+	if( line.text.empty() )
+	{
+		return;
+	}
+
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( mFont, line.text.c_str(), mTextColor );
+	if( textSurface == NULL )
+	{
+		printf( "Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError() );
+	}
+	else
+	{
+		line.texture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
+		if( line.texture == NULL )
+		{
+			printf( "Unable to create texture from rendered text! SDL Error: %s\n", SDL_GetError() );
+		}
+		else
+		{
+			line.width = textSurface->w;
+			line.height = textSurface->h;
+		}
+
+		SDL_FreeSurface( textSurface );
+	}
+}
+
+int LTextLayout::getAdvance( Uint32 previous, Uint32 glyph )
+{
+	if( glyph > 0xFFFF )
+	{
+		glyph = 0xFFFD;
+	}
+	if( previous > 0xFFFF )
+	{
+		previous = 0xFFFD;
+	}
+
+	int* page = mAdvancePages[ glyph / ADVANCE_PAGE_SIZE ];
+	if( page == NULL )
+	{
+		page = new int[ ADVANCE_PAGE_SIZE ];
+		for( int i = 0; i < ADVANCE_PAGE_SIZE; ++i )
+		{
+			page[ i ] = -1;
+		}
+		mAdvancePages[ glyph / ADVANCE_PAGE_SIZE ] = page;
+	}
+
+	int& advance = page[ glyph % ADVANCE_PAGE_SIZE ];
+	if( advance < 0 )
+	{
+		if( TTF_GlyphMetrics( mFont, (Uint16)glyph, NULL, NULL, NULL, NULL, &advance ) == -1 )
+		{
+			advance = 0;
+		}
+	}
+
+	int kerning = 0;
+	if( previous != 0 )
+	{
+		kerning = TTF_GetFontKerningSizeGlyphs( mFont, (Uint16)previous, (Uint16)glyph );
+	}
+
+	return advance + kerning;
+}
+
+void LTextLayout::freeAdvances()
+{
+	for( int i = 0; i < TOTAL_ADVANCE_PAGES; ++i )
+	{
+		delete[] mAdvancePages[ i ];
+		mAdvancePages[ i ] = NULL;
+	}
+}
+
 bool init()
 {
 	bool success = true;
@@ -252,6 +933,8 @@ bool loadMedia()
 			printf( "Failed to render prompt text!\n" );
 			success = false;
 		}
+
+		gInputTextLayout.setFont( gFont, textColor, SCREEN_WIDTH - TEXT_MARGIN * 2 );
 	}
 
 	return success;
@@ -260,7 +943,7 @@ bool loadMedia()
 void close()
 {
 	gPromptTextTexture.free();
-	gInputTextTexture.free();
+	gInputTextLayout.free();
 
 	TTF_CloseFont( gFont );
 	gFont = NULL;
@@ -275,6 +958,124 @@ void close()
 	SDL_Quit();
 }
 
+Uint32 decodeUTF8( std::string& text, int& position )
+{
+	Uint8 lead = text[ position ];
+
+	int length = 0;
+	Uint32 codepoint = 0;
+	if( lead < 0x80 )
+	{
+		++position;
+		return lead;
+	}
+	else if( lead >= 0xC2 && lead < 0xE0 )
+	{
+		length = 2;
+		codepoint = lead & 0x1F;
+	}
+	else if( lead >= 0xE0 && lead < 0xF0 )
+	{
+		length = 3;
+		codepoint = lead & 0x0F;
+	}
+	else if( lead >= 0xF0 && lead < 0xF5 )
+	{
+		length = 4;
+		codepoint = lead & 0x07;
+	}
+	else
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	if( position + length > (int)text.length() )
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	for( int i = 1; i < length; ++i )
+	{
+		Uint8 next = text[ position + i ];
+		if( ( next & 0xC0 ) != 0x80 )
+		{
+			++position;
+			return 0xFFFD;
+		}
+
+		codepoint = ( codepoint << 6 ) | ( next & 0x3F );
+	}
+
+	if( ( length == 3 && codepoint < 0x800 ) || ( length == 4 && codepoint < 0x10000 ) || ( codepoint >= 0xD800 && codepoint <= 0xDFFF ) || codepoint > 0x10FFFF )
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	position += length;
+	return codepoint;
+}
+
+void benchmarkTextLayout()
+{
+	std::string text;
+	for( int sentence = 0; (int)text.length() < BENCHMARK_TEXT_BYTES; ++sentence )
+	{
+		text += "The quick brown fox jumps over the lazy dog. ";
+		if( sentence % 8 == 7 )
+		{
+			text += '\n';
+		}
+	}
+
+	std::string keys = "Lazy Foo' Productions ";
+	SDL_Color textColor = { 0, 0, 0, 0xFF };
+
+	LTextLayout layout;
+	layout.setFont( gFont, textColor, SCREEN_WIDTH - TEXT_MARGIN * 2 );
+	layout.setText( text );
+
+	int caret = layout.getLength() / 2;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for( int i = 0; i < BENCHMARK_EDITS; ++i )
+	{
+		if( i % 8 == 7 )
+		{
+			caret = layout.replace( layout.getPreviousOffset( caret ), caret, "" );
+		}
+		else
+		{
+			caret = layout.replace( caret, caret, keys.substr( i % keys.length(), 1 ) );
+		}
+	}
+	double editTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_EDITS;
+
+	LTextLayout fullLayout;
+	fullLayout.setFont( gFont, textColor, SCREEN_WIDTH - TEXT_MARGIN * 2 );
+
+	caret = text.length() / 2;
+	start = SDL_GetPerformanceCounter();
+	for( int i = 0; i < BENCHMARK_FULL_EDITS; ++i )
+	{
+		if( i % 8 == 7 )
+		{
+			--caret;
+			text.erase( caret, 1 );
+		}
+		else
+		{
+			text.insert( caret, 1, keys[ i % keys.length() ] );
+			++caret;
+		}
+		fullLayout.setText( text );
+	}
+	double fullTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_FULL_EDITS;
+
+	printf( "%d byte buffer, %d lines: replace %.3f us per edit, full relayout %.3f us per edit\n", layout.getLength(), layout.getLineCount(), editTime, fullTime );
+}
+
 int main( int argc, char* args[] )
 {
 	if( !init() )
@@ -287,73 +1088,170 @@ int main( int argc, char* args[] )
 		{
 			printf( "Failed to load media!\n" );
 		}
+		else if( ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--benchmark" ) )
+		{
+			benchmarkTextLayout();
+		}
 		else
 		{	
 			bool quit = false;
 
 			SDL_Event e;
 
-			SDL_Color textColor = { 0, 0, 0, 0xFF };
+			gInputTextLayout.setText( "Some Text" );
+
+			int caret = gInputTextLayout.getLength();
+			int anchor = caret;
+			int scrollY = 0;
+
+			int textTop = gPromptTextTexture.getHeight();
+			int textHeight = SCREEN_HEIGHT - textTop;
 
-			std::string inputText = "Some Text";
-			gInputTextTexture.loadFromRenderedText( inputText.c_str(), textColor );
+			SDL_Rect selectionRects[ MAX_SELECTION_RECTS ];
 
 			SDL_StartTextInput();
 
 			while( !quit )
 			{
-				bool renderText = false;
-
 				while( SDL_PollEvent( &e ) != 0 )
 				{
+					int selectionStart = caret < anchor ? caret : anchor;
+					int selectionEnd = caret < anchor ? anchor : caret;
+
 					if( e.type == SDL_QUIT )
 					{
 						quit = true;
 					}
 					else if( e.type == SDL_KEYDOWN )
 					{
-						if( e.key.keysym.sym == SDLK_BACKSPACE && inputText.length() > 0 )
+						if( e.key.keysym.sym == SDLK_BACKSPACE )
+						{
+							if( selectionStart != selectionEnd )
+							{
+								caret = gInputTextLayout.replace( selectionStart, selectionEnd, "" );
+							}
+							else if( caret > 0 )
+							{
+								caret = gInputTextLayout.replace( gInputTextLayout.getPreviousOffset( caret ), caret, "" );
+							}
+							anchor = caret;
+						}
+						else if( e.key.keysym.sym == SDLK_RETURN )
 						{
-							inputText.pop_back();
-							renderText = true;
+							caret = gInputTextLayout.replace( selectionStart, selectionEnd, "\n" );
+							anchor = caret;
+						}
+						else if( e.key.keysym.sym == SDLK_LEFT || e.key.keysym.sym == SDLK_RIGHT )
+						{
+							if( e.key.keysym.sym == SDLK_LEFT )
+							{
+								caret = gInputTextLayout.getPreviousOffset( caret );
+							}
+							else
+							{
+								caret = gInputTextLayout.getNextOffset( caret );
+							}
+							if( !( SDL_GetModState() & KMOD_SHIFT ) )
+							{
+								anchor = caret;
+							}
+						}
+						else if( e.key.keysym.sym == SDLK_UP || e.key.keysym.sym == SDLK_DOWN )
+						{
+							SDL_Rect caretRect = gInputTextLayout.getCaretRect( caret );
+							if( e.key.keysym.sym == SDLK_UP )
+							{
+								caret = gInputTextLayout.hitTest( caretRect.x, caretRect.y - caretRect.h / 2 );
+							}
+							else
+							{
+								caret = gInputTextLayout.hitTest( caretRect.x, caretRect.y + caretRect.h + caretRect.h / 2 );
+							}
+							if( !( SDL_GetModState() & KMOD_SHIFT ) )
+							{
+								anchor = caret;
+							}
 						}
 						else if( e.key.keysym.sym == SDLK_c && SDL_GetModState() & KMOD_CTRL )
 						{
-							SDL_SetClipboardText( inputText.c_str() );
+							if( selectionStart != selectionEnd )
+							{
+								SDL_SetClipboardText( gInputTextLayout.getText( selectionStart, selectionEnd ).c_str() );
+							}
+							else
+							{
+								SDL_SetClipboardText( gInputTextLayout.getText( 0, gInputTextLayout.getLength() ).c_str() );
+							}
 						}
 						else if( e.key.keysym.sym == SDLK_v && SDL_GetModState() & KMOD_CTRL )
 						{
-							inputText = SDL_GetClipboardText();
-							renderText = true;
+							char* clipboardText = SDL_GetClipboardText();
+							if( clipboardText != NULL )
+							{
+								caret = gInputTextLayout.replace( selectionStart, selectionEnd, clipboardText );
+								anchor = caret;
+								SDL_free( clipboardText );
+							}
 						}
 					}
 					else if( e.type == SDL_TEXTINPUT )
 					{
 						if( !( ( e.text.text[ 0 ] == 'c' || e.text.text[ 0 ] == 'C' ) && ( e.text.text[ 0 ] == 'v' || e.text.text[ 0 ] == 'V' ) && SDL_GetModState() & KMOD_CTRL ) )
 						{
-							inputText += e.text.text;
-							renderText = true;
+							caret = gInputTextLayout.replace( selectionStart, selectionEnd, e.text.text );
+							anchor = caret;
+						}
+					}
+					else if( e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEMOTION )
+					{
+						int x, y;
+						Uint32 buttons = SDL_GetMouseState( &x, &y );
+						if( e.type == SDL_MOUSEBUTTONDOWN || buttons & SDL_BUTTON_LMASK )
+						{
+							caret = gInputTextLayout.hitTest( x - TEXT_MARGIN, y - textTop + scrollY );
+							if( e.type == SDL_MOUSEBUTTONDOWN && !( SDL_GetModState() & KMOD_SHIFT ) )
+							{
+								anchor = caret;
+							}
 						}
 					}
 				}
 
-				if( renderText )
+				SDL_Rect caretRect = gInputTextLayout.getCaretRect( caret );
+				if( caretRect.y < scrollY )
 				{
-					if( inputText != "" )
-					{
-						gInputTextTexture.loadFromRenderedText( inputText.c_str(), textColor );
-					}
-					else
-					{
-						gInputTextTexture.loadFromRenderedText( " ", textColor );
-					}
+					scrollY = caretRect.y;
+				}
+				if( caretRect.y + caretRect.h > scrollY + textHeight )
+				{
+					scrollY = caretRect.y + caretRect.h - textHeight;
 				}
 
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
 				gPromptTextTexture.render( ( SCREEN_WIDTH - gPromptTextTexture.getWidth() ) / 2, 0 );
-				gInputTextTexture.render( ( SCREEN_WIDTH - gInputTextTexture.getWidth() ) / 2, gPromptTextTexture.getHeight() );
+
+				SDL_Rect textArea = { 0, textTop, SCREEN_WIDTH, textHeight };
+				SDL_RenderSetClipRect( gRenderer, &textArea );
+
+				int selectionCount = gInputTextLayout.getSelectionRects( anchor, caret, scrollY, scrollY + textHeight, selectionRects, MAX_SELECTION_RECTS );
+				SDL_SetRenderDrawColor( gRenderer, 0xB0, 0xD0, 0xFF, 0xFF );
+				for( int i = 0; i < selectionCount; ++i )
+				{
+					selectionRects[ i ].x += TEXT_MARGIN;
+					selectionRects[ i ].y += textTop - scrollY;
+					SDL_RenderFillRect( gRenderer, &selectionRects[ i ] );
+				}
+
+				gInputTextLayout.render( TEXT_MARGIN, textTop - scrollY, scrollY, scrollY + textHeight );
+
+				caretRect.x += TEXT_MARGIN;
+				caretRect.y += textTop - scrollY;
+				SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+				SDL_RenderFillRect( gRenderer, &caretRect );
+
+				SDL_RenderSetClipRect( gRenderer, NULL );
 
 				SDL_RenderPresent( gRenderer );
 			}
@@ -2,11 +2,39 @@
 #include <SDL_image.h>
 #include <stdio.h>
 #include <string>
+#include <math.h>
+#include <new>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define PARTICLE_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define PARTICLE_SSE2
+#endif
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
 const int TOTAL_PARTICLES = 20;
+const int TOTAL_PARTICLE_SPRITES = 3;
+const int PARTICLE_LIFETIME = 10;
+
+const int BENCHMARK_PARTICLES = 1024 * 1024;
+const int BENCHMARK_FRAMES = 100;
+const int BENCHMARK_SPRITES = 100000;
+
+const int MAX_PARTICLE_THREADS = 8;
+const int PARTICLE_THREAD_THRESHOLD = 4096;
+const int PARTICLE_CACHE_LINE = 64;
+const int PARTICLE_CHUNK_ALIGN = 64;
+
+const int ATLAS_PADDING = 1;
+const int MAX_ATLAS_SKYLINE = 64;
+
+const int MAX_BATCH_SPRITES = 2048;
+
+const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
 
 class LTexture
 {
@@ -16,6 +44,8 @@ class LTexture
 		~LTexture();
 
 		bool loadFromFile( std::string path );
+
+		bool loadFromSurface( SDL_Surface* surface );
 		
 		#ifdef _SDL_TTF_H
 		bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
@@ -31,6 +61,8 @@ class LTexture
 		
 		void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
 
+		void renderGeometry( SDL_Vertex* vertices, int numVertices, int* indices, int numIndices );
+
 		int getWidth();
 		int getHeight();
 
@@ -41,21 +73,123 @@ class LTexture
 		int mHeight;
 };
 
-class Particle
+struct LSprite
+{
+	LTexture* texture;
+	SDL_Rect clip;
+};
+
+struct SkylineNode
+{
+	int x, y;
+	int width;
+};
+
+class LTextureAtlas
+{
+	public:
+		LTextureAtlas();
+
+		~LTextureAtlas();
+
+		bool begin( int width, int height );
+
+		bool add( std::string path, LSprite& sprite );
+
+		bool end();
+
+		void free();
+
+		LTexture& getTexture();
+
+	private:
+		bool findPosition( int width, int height, int& index, int& x, int& y );
+
+		void addSkylineLevel( int index, int x, int y, int width );
+
+		SDL_Surface* mSurface;
+
+		SkylineNode mSkyline[ MAX_ATLAS_SKYLINE ];
+		int mSkylineCount;
+
+		LTexture mTexture;
+};
+
+class LSpriteBatch
+{
+	public:
+		LSpriteBatch();
+
+		void draw( LTexture& texture, int x, int y, SDL_Rect* clip = NULL, SDL_Color* color = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
+
+		void flush();
+
+	private:
+		LTexture* mTexture;
+
+		SDL_Vertex mVertices[ MAX_BATCH_SPRITES * 4 ];
+		int mIndices[ MAX_BATCH_SPRITES * 6 ];
+		int mSpriteCount;
+};
+
+class ParticleSystem;
+
+struct ParticleWorker
+{
+	ParticleSystem* system;
+	SDL_Thread* thread;
+	SDL_sem* start;
+
+	int first;
+	int last;
+
+	Uint32 random;
+};
+
+class ParticleSystem
 {
 	public:
-		Particle( int x, int y );
+		ParticleSystem();
+
+		~ParticleSystem();
+
+		bool create( int capacity );
+
+		void free();
+
+		void emit( int x, int y );
+
+		void update( int x, int y );
 
 		void render();
 
-		bool isDead();
+		int getCount();
+		int getThreadCount();
 
 	private:
-		int mPosX, mPosY;
+		static int workerThread( void* data );
+
+		void spawn( int i, Uint32& random );
+
+		void updateRange( int first, int last, Uint32& random );
+
+		Uint8* mBlock;
+		int* mPosX;
+		int* mPosY;
+		int* mFrame;
+		Uint8* mSprite;
 
-		int mFrame;
+		int mCount;
+		int mCapacity;
 
-		LTexture *mTexture;
+		int mEmitX;
+		int mEmitY;
+		Uint32 mRandom;
+
+		ParticleWorker mWorkers[ MAX_PARTICLE_THREADS ];
+		int mWorkerCount;
+		SDL_sem* mWorkersDone;
+		bool mQuit;
 };
 
 
@@ -69,7 +203,7 @@ class Dot
 
 		Dot();
 
-		~Dot();
+		bool createParticles();
 
 		void handleEvent( SDL_Event& e );
 
@@ -78,7 +212,7 @@ class Dot
 		void render();
 
     private:
-		Particle* particles[ TOTAL_PARTICLES ];
+		ParticleSystem mParticles;
 
 		void renderParticles();
 
@@ -93,15 +227,26 @@ bool loadMedia();
 
 void close();
 
+void benchmarkParticles();
+
+void benchmarkSprites();
+
+Uint32 nextRandom( Uint32& state );
+
 SDL_Window* gWindow = NULL;
 
 SDL_Renderer* gRenderer = NULL;
 
 LTexture gDotTexture;
-LTexture gRedTexture;
-LTexture gGreenTexture;
-LTexture gBlueTexture;
-LTexture gShimmerTexture;
+LTextureAtlas gParticleAtlas;
+LSprite gRedSprite;
+LSprite gGreenSprite;
+LSprite gBlueSprite;
+LSprite gShimmerSprite;
+LSprite* gParticleSprites[ TOTAL_PARTICLE_SPRITES ] = { &gRedSprite, &gGreenSprite, &gBlueSprite };
+LSpriteBatch gSpriteBatch;
+
+SDL_Color gParticleColor = { 0xFF, 0xFF, 0xFF, 192 };
 
 LTexture::LTexture()
 {
@@ -148,12 +293,30 @@ bool LTexture::loadFromFile( std::string path )
 	return mTexture != NULL;
 }
 
+bool LTexture::loadFromSurface( SDL_Surface* surface )
+{
+	free();
+
+	mTexture = SDL_CreateTextureFromSurface( gRenderer, surface );
+	if( mTexture == NULL )
+	{
+		printf( "Unable to create texture from surface! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		mWidth = surface->w;
+		mHeight = surface->h;
+	}
+
+	return mTexture != NULL;
+}
+
 #ifdef _SDL_TTF_H
 bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColor )
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -218,6 +381,11 @@ void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* ce
 	SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
 }
 
+void LTexture::renderGeometry( SDL_Vertex* vertices, int numVertices, int* indices, int numIndices )
+{
+	SDL_RenderGeometry( gRenderer, mTexture, vertices, numVertices, indices, numIndices );
+}
+
 int LTexture::getWidth()
 {
 	return mWidth;
@@ -228,36 +396,566 @@ int LTexture::getHeight()
 	return mHeight;
 }
 
-Particle::Particle( int x, int y )
+LTextureAtlas::LTextureAtlas()
+{
+	mSurface = NULL;
+	mSkylineCount = 0;
+}
+
+LTextureAtlas::~LTextureAtlas()
 {
-    mPosX = x - 5 + ( rand() % 25 );
-    mPosY = y - 5 + ( rand() % 25 );
+	free();
+}
 
-    mFrame = rand() % 5;
+bool LTextureAtlas::begin( int width, int height )
+{
+	free();
 
-    switch( rand() % 3 )
-    {
-        case 0: mTexture = &gRedTexture; break;
-        case 1: mTexture = &gGreenTexture; break;
-        case 2: mTexture = &gBlueTexture; break;
-    }
+	mSurface = SDL_CreateRGBSurfaceWithFormat( 0, width, height, 32, SDL_PIXELFORMAT_RGBA8888 );
+	if( mSurface == NULL )
+	{
+		printf( "Unable to create atlas surface! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		SDL_FillRect( mSurface, NULL, SDL_MapRGBA( mSurface->format, 0, 0, 0, 0 ) );
+
+		mSkyline[ 0 ].x = 0;
+		mSkyline[ 0 ].y = 0;
+		mSkyline[ 0 ].width = width;
+		mSkylineCount = 1;
+	}
+
+	return mSurface != NULL;
 }
 
-void Particle::render()
+bool LTextureAtlas::add( std::string path, LSprite& sprite )
 {
-	mTexture->render( mPosX, mPosY );
+	bool success = false;
 
-    if( mFrame % 2 == 0 )
-    {
-		gShimmerTexture.render( mPosX, mPosY );
-    }
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+	}
+	else
+	{
+		int index, x, y;
+
+		if( !findPosition( loadedSurface->w + ATLAS_PADDING, loadedSurface->h + ATLAS_PADDING, index, x, y ) )
+		{
+			printf( "Unable to fit image %s into atlas!\n", path.c_str() );
+		}
+		else
+		{
+			SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+
+			SDL_Rect clip = { x, y, loadedSurface->w, loadedSurface->h };
+			SDL_BlitSurface( loadedSurface, NULL, mSurface, &clip );
+
+			addSkylineLevel( index, x, y + loadedSurface->h + ATLAS_PADDING, loadedSurface->w + ATLAS_PADDING );
+
+			sprite.texture = &mTexture;
+			sprite.clip = clip;
+			success = true;
+		}
+
+		SDL_FreeSurface( loadedSurface );
+	}
+
+	return success;
+}
+
+bool LTextureAtlas::end()
+{
+	bool success = false;
+
+	if( mSurface != NULL )
+	{
+		success = mTexture.loadFromSurface( mSurface );
+
+		SDL_FreeSurface( mSurface );
+		mSurface = NULL;
+		mSkylineCount = 0;
+	}
+
+	return success;
+}
+
+void LTextureAtlas::free()
+{
+	if( mSurface != NULL )
+	{
+		SDL_FreeSurface( mSurface );
+		mSurface = NULL;
+	}
+
+	mSkylineCount = 0;
+
+	mTexture.free();
+}
+
+LTexture& LTextureAtlas::getTexture()
+{
+	return mTexture;
+}
+
+bool LTextureAtlas::findPosition( int width, int height, int& index, int& x, int& y )
+{
+	index = -1;
+
+	if( mSkylineCount >= MAX_ATLAS_SKYLINE )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < mSkylineCount; ++i )
+	{
+		int nodeX = mSkyline[ i ].x;
+		if( nodeX + width > mSurface->w )
+		{
+			break;
+		}
+
+		int nodeY = 0;
+		for( int j = i, widthLeft = width; widthLeft > 0; ++j )
+		{
+			nodeY = SDL_max( nodeY, mSkyline[ j ].y );
+			widthLeft -= mSkyline[ j ].width;
+		}
+
+		if( ( nodeY + height <= mSurface->h ) && ( ( index == -1 ) || ( nodeY < y ) ) )
+		{
+			index = i;
+			x = nodeX;
+			y = nodeY;
+		}
+	}
+
+	return index != -1;
+}
+
+void LTextureAtlas::addSkylineLevel( int index, int x, int y, int width )
+{
+	for( int i = mSkylineCount; i > index; --i )
+	{
+		mSkyline[ i ] = mSkyline[ i - 1 ];
+	}
+	++mSkylineCount;
+
+	mSkyline[ index ].x = x;
+	mSkyline[ index ].y = y;
+	mSkyline[ index ].width = width;
+
+	for( int i = index + 1; i < mSkylineCount; )
+	{
+		int shrink = mSkyline[ i - 1 ].x + mSkyline[ i - 1 ].width - mSkyline[ i ].x;
+		if( shrink <= 0 )
+		{
+			break;
+		}
+
+		mSkyline[ i ].x += shrink;
+		mSkyline[ i ].width -= shrink;
+
+		if( mSkyline[ i ].width > 0 )
+		{
+			break;
+		}
+
+		for( int j = i; j < mSkylineCount - 1; ++j )
+		{
+			mSkyline[ j ] = mSkyline[ j + 1 ];
+		}
+		--mSkylineCount;
+	}
+
+	for( int i = 0; i < mSkylineCount - 1; )
+	{
+		if( mSkyline[ i ].y == mSkyline[ i + 1 ].y )
+		{
+			mSkyline[ i ].width += mSkyline[ i + 1 ].width;
+
+			for( int j = i + 1; j < mSkylineCount - 1; ++j )
+			{
+				mSkyline[ j ] = mSkyline[ j + 1 ];
+			}
+			--mSkylineCount;
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+LSpriteBatch::LSpriteBatch()
+{
+	mTexture = NULL;
+	mSpriteCount = 0;
+
+	for( int i = 0; i < MAX_BATCH_SPRITES; ++i )
+	{
+		mIndices[ i * 6 + 0 ] = i * 4 + 0;
+		mIndices[ i * 6 + 1 ] = i * 4 + 1;
+		mIndices[ i * 6 + 2 ] = i * 4 + 2;
+		mIndices[ i * 6 + 3 ] = i * 4 + 2;
+		mIndices[ i * 6 + 4 ] = i * 4 + 3;
+		mIndices[ i * 6 + 5 ] = i * 4 + 0;
+	}
+}
+
+void LSpriteBatch::draw( LTexture& texture, int x, int y, SDL_Rect* clip, SDL_Color* color, double angle, SDL_Point* center, SDL_RendererFlip flip )
+{
+	if( ( mTexture != &texture ) || ( mSpriteCount == MAX_BATCH_SPRITES ) )
+	{
+		flush();
+		mTexture = &texture;
+	}
+
+	SDL_Rect source = { 0, 0, texture.getWidth(), texture.getHeight() };
+	if( clip != NULL )
+	{
+		source = *clip;
+	}
+
+	float u0 = (float)source.x / texture.getWidth();
+	float v0 = (float)source.y / texture.getHeight();
+	float u1 = (float)( source.x + source.w ) / texture.getWidth();
+	float v1 = (float)( source.y + source.h ) / texture.getHeight();
+
+	if( flip & SDL_FLIP_HORIZONTAL )
+	{
+		float u = u0;
+		u0 = u1;
+		u1 = u;
+	}
+	if( flip & SDL_FLIP_VERTICAL )
+	{
+		float v = v0;
+		v0 = v1;
+		v1 = v;
+	}
+
+	SDL_FPoint corners[ 4 ] = { { 0.f, 0.f }, { (float)source.w, 0.f }, { (float)source.w, (float)source.h }, { 0.f, (float)source.h } };
+
+	if( angle != 0.0 )
+	{
+		float centerX = center != NULL ? center->x : source.w / 2.f;
+		float centerY = center != NULL ? center->y : source.h / 2.f;
+		float radians = (float)( angle * DEGREES_TO_RADIANS );
+		float cosine = cosf( radians );
+		float sine = sinf( radians );
+
+		for( int i = 0; i < 4; ++i )
+		{
+			float cornerX = corners[ i ].x - centerX;
+			float cornerY = corners[ i ].y - centerY;
+			corners[ i ].x = centerX + cornerX * cosine - cornerY * sine;
+			corners[ i ].y = centerY + cornerX * sine + cornerY * cosine;
+		}
+	}
+
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	if( color == NULL )
+	{
+		color = &white;
+	}
+
+	SDL_FPoint texCoords[ 4 ] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+
+	SDL_Vertex* vertices = &mVertices[ mSpriteCount * 4 ];
+	for( int i = 0; i < 4; ++i )
+	{
+		vertices[ i ].position.x = x + corners[ i ].x;
+		vertices[ i ].position.y = y + corners[ i ].y;
+		vertices[ i ].color = *color;
+		vertices[ i ].tex_coord = texCoords[ i ];
+	}
+
+	++mSpriteCount;
+}
+
+void LSpriteBatch::flush()
+{
+	if( mSpriteCount > 0 )
+	{
+		mTexture->renderGeometry( mVertices, mSpriteCount * 4, mIndices, mSpriteCount * 6 );
+		mSpriteCount = 0;
+	}
+}
+
+ParticleSystem::ParticleSystem()
+{
+	mBlock = NULL;
+	mPosX = NULL;
+	mPosY = NULL;
+	mFrame = NULL;
+	mSprite = NULL;
+
+	mCount = 0;
+	mCapacity = 0;
+
+	mEmitX = 0;
+	mEmitY = 0;
+	mRandom = 2463534242u;
+
+	mWorkerCount = 0;
+	mWorkersDone = NULL;
+	mQuit = false;
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	free();
+}
+
+bool ParticleSystem::create( int capacity )
+{
+	free();
+
+	int intBytes = ( capacity * (int)sizeof( int ) + PARTICLE_CACHE_LINE - 1 ) / PARTICLE_CACHE_LINE * PARTICLE_CACHE_LINE;
+	int spriteBytes = ( capacity + PARTICLE_CACHE_LINE - 1 ) / PARTICLE_CACHE_LINE * PARTICLE_CACHE_LINE;
+
+	mBlock = new (std::nothrow) Uint8[ intBytes * 3 + spriteBytes + PARTICLE_CACHE_LINE ];
+	if( mBlock == NULL )
+	{
+		printf( "Unable to allocate %d particles!\n", capacity );
+		return false;
+	}
+
+	Uint8* base = mBlock + ( PARTICLE_CACHE_LINE - (uintptr_t)mBlock % PARTICLE_CACHE_LINE ) % PARTICLE_CACHE_LINE;
+	mPosX = (int*)base;
+	mPosY = (int*)( base + intBytes );
+	mFrame = (int*)( base + intBytes * 2 );
+	mSprite = base + intBytes * 3;
+
+	mCapacity = capacity;
+
+	if( capacity >= PARTICLE_THREAD_THRESHOLD )
+	{
+		int workerCount = SDL_GetCPUCount() - 1;
+		if( workerCount > MAX_PARTICLE_THREADS )
+		{
+			workerCount = MAX_PARTICLE_THREADS;
+		}
+
+		mWorkersDone = SDL_CreateSemaphore( 0 );
+		mQuit = false;
+
+		for( int i = 0; i < workerCount && mWorkersDone != NULL; ++i )
+		{
+			ParticleWorker& worker = mWorkers[ i ];
+			worker.system = this;
+			worker.start = SDL_CreateSemaphore( 0 );
+			worker.first = 0;
+			worker.last = 0;
+			worker.random = mRandom ^ ( ( i + 1 ) * 2654435761u );
+			worker.thread = NULL;
+
+			if( worker.start != NULL )
+			{
+				worker.thread = SDL_CreateThread( workerThread, "ParticleWorker", &worker );
+			}
+
+			if( worker.thread == NULL )
+			{
+				printf( "Unable to create particle worker! SDL Error: %s\n", SDL_GetError() );
+				if( worker.start != NULL )
+				{
+					SDL_DestroySemaphore( worker.start );
+				}
+				break;
+			}
+
+			++mWorkerCount;
+		}
+	}
+
+	return true;
+}
+
+void ParticleSystem::free()
+{
+	mQuit = true;
+	for( int i = 0; i < mWorkerCount; ++i )
+	{
+		SDL_SemPost( mWorkers[ i ].start );
+		SDL_WaitThread( mWorkers[ i ].thread, NULL );
+		SDL_DestroySemaphore( mWorkers[ i ].start );
+	}
+	mWorkerCount = 0;
+
+	if( mWorkersDone != NULL )
+	{
+		SDL_DestroySemaphore( mWorkersDone );
+		mWorkersDone = NULL;
+	}
+
+	if( mBlock != NULL )
+	{
+		delete[] mBlock;
+		mBlock = NULL;
+		mPosX = NULL;
+		mPosY = NULL;
+		mFrame = NULL;
+		mSprite = NULL;
+
+		mCount = 0;
+		mCapacity = 0;
+	}
+}
+
+void ParticleSystem::emit( int x, int y )
+{
+	mEmitX = x;
+	mEmitY = y;
+
+	while( mCount < mCapacity )
+	{
+		spawn( mCount, mRandom );
+
+		++mCount;
+	}
+}
+
+void ParticleSystem::update( int x, int y )
+{
+	mEmitX = x;
+	mEmitY = y;
+
+	if( mWorkerCount == 0 || mCount < PARTICLE_THREAD_THRESHOLD )
+	{
+		updateRange( 0, mCount, mRandom );
+		return;
+	}
+
+	int chunk = mCount / ( mWorkerCount + 1 );
+	chunk -= chunk % PARTICLE_CHUNK_ALIGN;
+
+	for( int i = 0; i < mWorkerCount; ++i )
+	{
+		mWorkers[ i ].first = i * chunk;
+		mWorkers[ i ].last = ( i + 1 ) * chunk;
+		SDL_SemPost( mWorkers[ i ].start );
+	}
+
+	updateRange( mWorkerCount * chunk, mCount, mRandom );
+
+	for( int i = 0; i < mWorkerCount; ++i )
+	{
+		SDL_SemWait( mWorkersDone );
+	}
+}
+
+void ParticleSystem::render()
+{
+	for( int i = 0; i < mCount; ++i )
+	{
+		LSprite* sprite = gParticleSprites[ mSprite[ i ] ];
+
+		gSpriteBatch.draw( *sprite->texture, mPosX[ i ], mPosY[ i ], &sprite->clip, &gParticleColor );
+
+		if( mFrame[ i ] % 2 == 0 )
+		{
+			gSpriteBatch.draw( *gShimmerSprite.texture, mPosX[ i ], mPosY[ i ], &gShimmerSprite.clip, &gParticleColor );
+		}
+	}
+}
+
+int ParticleSystem::getCount()
+{
+	return mCount;
+}
+
+int ParticleSystem::getThreadCount()
+{
+	return mWorkerCount + 1;
+}
+
+int ParticleSystem::workerThread( void* data )
+{
+	ParticleWorker* worker = (ParticleWorker*)data;
+	ParticleSystem* system = worker->system;
+
+	while( true )
+	{
+		SDL_SemWait( worker->start );
+
+		if( system->mQuit )
+		{
+			break;
+		}
+
+		system->updateRange( worker->first, worker->last, worker->random );
+
+		SDL_SemPost( system->mWorkersDone );
+	}
 
-    mFrame++;
+	return 0;
 }
 
-bool Particle::isDead()
+void ParticleSystem::spawn( int i, Uint32& random )
 {
-    return mFrame > 10;
+	mPosX[ i ] = mEmitX - 5 + (int)( nextRandom( random ) % 25 );
+	mPosY[ i ] = mEmitY - 5 + (int)( nextRandom( random ) % 25 );
+
+	mFrame[ i ] = (int)( nextRandom( random ) % 5 );
+
+	mSprite[ i ] = (Uint8)( nextRandom( random ) % TOTAL_PARTICLE_SPRITES );
+}
+
+void ParticleSystem::updateRange( int first, int last, Uint32& random )
+{
+	int i = first;
+
+#if defined( PARTICLE_AVX2 )
+	__m256i one = _mm256_set1_epi32( 1 );
+	__m256i lifetime = _mm256_set1_epi32( PARTICLE_LIFETIME );
+
+	for( ; i + 8 <= last; i += 8 )
+	{
+		__m256i frames = _mm256_add_epi32( _mm256_loadu_si256( (__m256i*)&mFrame[ i ] ), one );
+		_mm256_storeu_si256( (__m256i*)&mFrame[ i ], frames );
+
+		int dead = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpgt_epi32( frames, lifetime ) ) );
+		for( int lane = 0; dead != 0; ++lane, dead >>= 1 )
+		{
+			if( dead & 1 )
+			{
+				spawn( i + lane, random );
+			}
+		}
+	}
+#elif defined( PARTICLE_SSE2 )
+	__m128i one = _mm_set1_epi32( 1 );
+	__m128i lifetime = _mm_set1_epi32( PARTICLE_LIFETIME );
+
+	for( ; i + 4 <= last; i += 4 )
+	{
+		__m128i frames = _mm_add_epi32( _mm_loadu_si128( (__m128i*)&mFrame[ i ] ), one );
+		_mm_storeu_si128( (__m128i*)&mFrame[ i ], frames );
+
+		int dead = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpgt_epi32( frames, lifetime ) ) );
+		for( int lane = 0; dead != 0; ++lane, dead >>= 1 )
+		{
+			if( dead & 1 )
+			{
+				spawn( i + lane, random );
+			}
+		}
+	}
+#endif
+
+	for( ; i < last; ++i )
+	{
+		++mFrame[ i ];
+
+		if( mFrame[ i ] > PARTICLE_LIFETIME )
+		{
+			spawn( i, random );
+		}
+	}
 }
 
 Dot::Dot()
@@ -267,19 +965,17 @@ Dot::Dot()
 
     mVelX = 0;
     mVelY = 0;
-
-    for( int i = 0; i < TOTAL_PARTICLES; ++i )
-    {
-        particles[ i ] = new Particle( mPosX, mPosY );
-    }
 }
 
-Dot::~Dot()
+bool Dot::createParticles()
 {
-    for( int i = 0; i < TOTAL_PARTICLES; ++i )
+    if( !mParticles.create( TOTAL_PARTICLES ) )
     {
-        delete particles[ i ];
+        return false;
     }
+
+    mParticles.emit( mPosX, mPosY );
+    return true;
 }
 
 void Dot::handleEvent( SDL_Event& e )
@@ -332,19 +1028,9 @@ void Dot::render()
 
 void Dot::renderParticles()
 {
-    for( int i = 0; i < TOTAL_PARTICLES; ++i )
-    {
-        if( particles[ i ]->isDead() )
-        {
-            delete particles[ i ];
-            particles[ i ] = new Particle( mPosX, mPosY );
-        }
-    }
+    mParticles.update( mPosX, mPosY );
 
-    for( int i = 0; i < TOTAL_PARTICLES; ++i )
-    {
-        particles[ i ]->render();
-    }
+    mParticles.render();
 }
 
 bool init()
@@ -404,34 +1090,43 @@ bool loadMedia()
 		success = false;
 	}
 
-	if( !gRedTexture.loadFromFile( "38_particle_engines/red.bmp" ) )
+	if( !gParticleAtlas.begin( 64, 64 ) )
 	{
-		printf( "Failed to load red texture!\n" );
+		printf( "Failed to create particle atlas!\n" );
 		success = false;
 	}
-
-	if( !gGreenTexture.loadFromFile( "38_particle_engines/green.bmp" ) )
+	else
 	{
-		printf( "Failed to load green texture!\n" );
-		success = false;
-	}
+		if( !gParticleAtlas.add( "38_particle_engines/red.bmp", gRedSprite ) )
+		{
+			printf( "Failed to load red texture!\n" );
+			success = false;
+		}
 
-	if( !gBlueTexture.loadFromFile( "38_particle_engines/blue.bmp" ) )
-	{
-		printf( "Failed to load blue texture!\n" );
-		success = false;
-	}
+		if( !gParticleAtlas.add( "38_particle_engines/green.bmp", gGreenSprite ) )
+		{
+			printf( "Failed to load green texture!\n" );
+			success = false;
+		}
 
-	if( !gShimmerTexture.loadFromFile( "38_particle_engines/shimmer.bmp" ) )
-	{
-		printf( "Failed to load shimmer texture!\n" );
-		success = false;
+		if( !gParticleAtlas.add( "38_particle_engines/blue.bmp", gBlueSprite ) )
+		{
+			printf( "Failed to load blue texture!\n" );
+			success = false;
+		}
+
+		if( !gParticleAtlas.add( "38_particle_engines/shimmer.bmp", gShimmerSprite ) )
+		{
+			printf( "Failed to load shimmer texture!\n" );
+			success = false;
+		}
+
+		if( !gParticleAtlas.end() )
+		{
+			printf( "Failed to build particle atlas!\n" );
+			success = false;
+		}
 	}
-	
-	gRedTexture.setAlpha( 192 );
-	gGreenTexture.setAlpha( 192 );
-	gBlueTexture.setAlpha( 192 );
-	gShimmerTexture.setAlpha( 192 );
 
 	return success;
 }
@@ -439,10 +1134,7 @@ bool loadMedia()
 void close()
 {
 	gDotTexture.free();
-	gRedTexture.free();
-	gGreenTexture.free();
-	gBlueTexture.free();
-	gShimmerTexture.free();
+	gParticleAtlas.free();
 
 	SDL_DestroyRenderer( gRenderer );
 	SDL_DestroyWindow( gWindow );
@@ -453,8 +1145,73 @@ void close()
 	SDL_Quit();
 }
 
+Uint32 nextRandom( Uint32& state )
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	return state;
+}
+
+void benchmarkParticles()
+{
+	ParticleSystem particles;
+
+	if( !particles.create( BENCHMARK_PARTICLES ) )
+	{
+		printf( "Unable to create %d particles!\n", BENCHMARK_PARTICLES );
+		return;
+	}
+
+	particles.emit( SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 );
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for( int i = 0; i < BENCHMARK_FRAMES; ++i )
+	{
+		particles.update( SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 );
+	}
+	Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+	printf( "Particle update: %d particles, %d threads, %.3f ms per frame\n", particles.getCount(), particles.getThreadCount(), elapsed * 1000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_FRAMES );
+}
+
+void benchmarkSprites()
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+	for( int i = 0; i < BENCHMARK_SPRITES; ++i )
+	{
+		LSprite* sprite = gParticleSprites[ i % TOTAL_PARTICLE_SPRITES ];
+		sprite->texture->render( ( i * 37 ) % ( SCREEN_WIDTH - sprite->clip.w ), ( i * 91 ) % ( SCREEN_HEIGHT - sprite->clip.h ), &sprite->clip );
+	}
+	SDL_RenderFlush( gRenderer );
+	double renderTime = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+
+	start = SDL_GetPerformanceCounter();
+	for( int i = 0; i < BENCHMARK_SPRITES; ++i )
+	{
+		LSprite* sprite = gParticleSprites[ i % TOTAL_PARTICLE_SPRITES ];
+		gSpriteBatch.draw( *sprite->texture, ( i * 37 ) % ( SCREEN_WIDTH - sprite->clip.w ), ( i * 91 ) % ( SCREEN_HEIGHT - sprite->clip.h ), &sprite->clip );
+	}
+	gSpriteBatch.flush();
+	SDL_RenderFlush( gRenderer );
+	double batchTime = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+
+	SDL_RendererInfo info;
+	SDL_GetRendererInfo( gRenderer, &info );
+
+	printf( "Sprite submission: %d sprites on %s, per-call render %.3f ms, batched %.3f ms\n", BENCHMARK_SPRITES, info.name, renderTime, batchTime );
+}
+
 int main( int argc, char* args[] )
 {
+	bool benchmark = ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--benchmark" );
+	if( benchmark )
+	{
+		SDL_setenv( "SDL_VIDEODRIVER", "dummy", 1 );
+		SDL_SetHint( SDL_HINT_RENDER_DRIVER, "software" );
+	}
+
 	if( !init() )
 	{
 		printf( "Failed to initialize!\n" );
@@ -465,6 +1222,11 @@ int main( int argc, char* args[] )
 		{
 			printf( "Failed to load media!\n" );
 		}
+		else if( benchmark )
+		{
+			benchmarkParticles();
+			benchmarkSprites();
+		}
 		else
 		{	
 			bool quit = false;
@@ -472,6 +1234,11 @@ int main( int argc, char* args[] )
 			SDL_Event e;
 
 			Dot dot;
+			if( !dot.createParticles() )
+			{
+				printf( "Failed to create dot particles!\n" );
+				quit = true;
+			}
 
 			while( !quit )
 			{
@@ -492,6 +1259,8 @@ int main( int argc, char* args[] )
 
 				dot.render();
 
+				gSpriteBatch.flush();
+
 				SDL_RenderPresent( gRenderer );
 			}
 		}
@@ -1,4 +1,5 @@
 #include <SDL.h>
+#include <SDL_thread.h>
 #include <SDL_image.h>
 #include <stdio.h>
 #include <string>
@@ -12,7 +13,9 @@ const int LEVEL_HEIGHT = 960;
 
 const int TILE_WIDTH = 80;
 const int TILE_HEIGHT = 80;
-const int TOTAL_TILES = 192;
+const int LEVEL_COLUMNS = LEVEL_WIDTH / TILE_WIDTH;
+const int LEVEL_ROWS = LEVEL_HEIGHT / TILE_HEIGHT;
+const int TOTAL_TILES = LEVEL_COLUMNS * LEVEL_ROWS;
 const int TOTAL_TILE_SPRITES = 12;
 
 const int TILE_RED = 0;
@@ -28,6 +31,60 @@ const int TILE_BOTTOMLEFT = 9;
 const int TILE_LEFT = 10;
 const int TILE_TOPLEFT = 11;
 
+const int CHUNK_TILES = 8;
+const int TOTAL_CHUNK_TEXTURES = 16;
+const int TOTAL_CHUNK_PAGES = 32;
+const int CHUNK_STREAM_MARGIN = 1;
+
+const Uint32 LEVEL_MAGIC = 0x314C564C;
+
+const int TOTAL_BENCHMARK_LEVELS = 4;
+const int BENCHMARK_LEVEL_SIDES[ TOTAL_BENCHMARK_LEVELS ] = { 32, 316, 2048, 4096 };
+const int BENCHMARK_QUERIES = 100000;
+const int BENCHMARK_SCAN_QUERIES = 20;
+const int BENCHMARK_FRAMES = 1000;
+
+const Uint32 PACK_MAGIC = 0x314B4150;
+const Uint32 PACK_PIXEL_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+
+const int PACK_IMAGE_DOT = 0;
+const int PACK_IMAGE_TILES = 1;
+const int TOTAL_PACK_IMAGES = 2;
+
+struct LevelHeader
+{
+	Uint32 magic;
+	Sint32 columns;
+	Sint32 rows;
+	Sint32 tileWidth;
+	Sint32 tileHeight;
+	Sint32 spriteCount;
+};
+
+struct PackHeader
+{
+	Uint32 magic;
+	Uint32 pixelFormat;
+	Sint32 imageCount;
+	Sint32 clipCount;
+};
+
+struct PackImage
+{
+	Sint32 width;
+	Sint32 height;
+	Sint32 pitch;
+	Sint32 pixelOffset;
+	Sint32 firstClip;
+	Sint32 clipCount;
+};
+
+struct ChunkRequest
+{
+	int page;
+	int chunk;
+};
+
 class LTexture
 {
 	public:
@@ -36,11 +93,15 @@ class LTexture
 		~LTexture();
 
 		bool loadFromFile( std::string path );
+
+		bool loadFromPixels( void* pixels, int width, int height, int pitch, Uint32 format );
 		
 		#ifdef _SDL_TTF_H
 		bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
 		#endif
 
+		bool createBlank( int width, int height, SDL_TextureAccess = SDL_TEXTUREACCESS_STREAMING );
+
 		void free();
 
 		void setColor( Uint8 red, Uint8 green, Uint8 blue );
@@ -51,6 +112,8 @@ class LTexture
 		
 		void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
 
+		void setAsRenderTarget();
+
 		int getWidth();
 		int getHeight();
 
@@ -61,21 +124,83 @@ class LTexture
 		int mHeight;
 };
 
-class Tile
+class TileMap
 {
     public:
-		Tile( int x, int y, int tileType );
+		TileMap();
+
+		~TileMap();
+
+		bool loadFromFile( std::string path );
+
+		void free();
+
+		void streamChunks( SDL_Rect& camera );
 
 		void render( SDL_Rect& camera );
 
-		int getType();
+		int getType( int column, int row );
+
+		void setType( int column, int row, int tileType );
 
-		SDL_Rect getBox();
+		SDL_Rect getBox( int column, int row );
+
+		void getTileRange( SDL_Rect box, int& firstColumn, int& lastColumn, int& firstRow, int& lastRow );
+
+		int getColumns();
+		int getRows();
+
+		int getWidth();
+		int getHeight();
 
     private:
-		SDL_Rect mBox;
+		static int streamThread( void* data );
+
+		int streamLoop();
+
+		void readChunk( SDL_RWops* file, int chunk, Uint8* tiles );
+
+		void requestChunk( int chunk );
+
+		int getPage( int chunk );
+
+		int getChunkSlot( int chunk );
+
+		void bakeChunk( int slot, Uint8* tiles );
+
+		std::string mPath;
+
+		int mColumns;
+		int mRows;
+		int mSpriteCount;
+
+		int mChunkColumns;
+		int mChunkRows;
 
-		int mType;
+		Uint8* mPageTiles;
+		int mPageOwners[ TOTAL_CHUNK_PAGES ];
+		bool mPageReady[ TOTAL_CHUNK_PAGES ];
+		Uint32 mPageLastUsed[ TOTAL_CHUNK_PAGES ];
+
+		SDL_Thread* mStreamThread;
+		SDL_mutex* mStreamLock;
+		SDL_cond* mStreamCondition;
+		bool mStreamQuit;
+
+		ChunkRequest mRequests[ TOTAL_CHUNK_PAGES ];
+		int mRequestFirst;
+		int mRequestCount;
+
+		ChunkRequest mLoaded[ TOTAL_CHUNK_PAGES ];
+		int mLoadedFirst;
+		int mLoadedCount;
+
+		LTexture mChunkTextures[ TOTAL_CHUNK_TEXTURES ];
+		int mChunkOwners[ TOTAL_CHUNK_TEXTURES ];
+		bool mChunkDirty[ TOTAL_CHUNK_TEXTURES ];
+		Uint32 mChunkLastUsed[ TOTAL_CHUNK_TEXTURES ];
+
+		Uint32 mFrame;
 };
 
 class Dot
@@ -90,9 +215,9 @@ class Dot
 
 		void handleEvent( SDL_Event& e );
 
-		void move( Tile *tiles[] );
+		void move( TileMap& tiles );
 
-		void setCamera( SDL_Rect& camera );
+		void setCamera( SDL_Rect& camera, TileMap& tiles );
 
 		void render( SDL_Rect& camera );
 
@@ -104,15 +229,29 @@ class Dot
 
 bool init();
 
-bool loadMedia( Tile* tiles[] );
+bool loadMedia( TileMap& tiles );
 
-void close( Tile* tiles[] );
+void close( TileMap& tiles );
 
 bool checkCollision( SDL_Rect a, SDL_Rect b );
 
-bool touchesWall( SDL_Rect box, Tile* tiles[] );
+bool touchesWall( SDL_Rect box, TileMap& tiles );
+
+bool convertMap( std::string mapPath, std::string levelPath );
+
+bool setTiles( TileMap& tiles );
+
+void setTileClips();
+
+SDL_Surface* cookSurface( std::string path );
+
+bool cookPack( std::string packPath );
+
+bool loadPack( std::string packPath );
 
-bool setTiles( Tile *tiles[] );
+bool writeBenchmarkLevel( std::string levelPath, int columns, int rows );
+
+void benchmarkLevels();
 
 SDL_Window* gWindow = NULL;
 
@@ -122,6 +261,8 @@ LTexture gDotTexture;
 LTexture gTileTexture;
 SDL_Rect gTileClips[ TOTAL_TILE_SPRITES ];
 
+SDL_BlendMode gPremultipliedBlend = SDL_BLENDMODE_BLEND;
+
 LTexture::LTexture()
 {
 	mTexture = NULL;
@@ -167,12 +308,39 @@ bool LTexture::loadFromFile( std::string path )
 	return mTexture != NULL;
 }
 
+bool LTexture::loadFromPixels( void* pixels, int width, int height, int pitch, Uint32 format )
+{
+	free();
+
+	SDL_Texture* newTexture = SDL_CreateTexture( gRenderer, format, SDL_TEXTUREACCESS_STATIC, width, height );
+	if( newTexture == NULL )
+	{
+		printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
+	}
+	else if( SDL_UpdateTexture( newTexture, NULL, pixels, pitch ) != 0 )
+	{
+		printf( "Unable to upload texture pixels! SDL Error: %s\n", SDL_GetError() );
+		SDL_DestroyTexture( newTexture );
+		newTexture = NULL;
+	}
+	else
+	{
+		SDL_SetTextureBlendMode( newTexture, gPremultipliedBlend );
+
+		mWidth = width;
+		mHeight = height;
+	}
+
+	mTexture = newTexture;
+	return mTexture != NULL;
+}
+
 #ifdef _SDL_TTF_H
 bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColor )
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -197,6 +365,22 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 	return mTexture != NULL;
 }
 #endif
+		
+bool LTexture::createBlank( int width, int height, SDL_TextureAccess access )
+{
+	mTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, access, width, height );
+	if( mTexture == NULL )
+	{
+		printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		mWidth = width;
+		mHeight = height;
+	}
+
+	return mTexture != NULL;
+}
 
 void LTexture::free()
 {
@@ -224,56 +408,542 @@ void LTexture::setAlpha( Uint8 alpha )
 	SDL_SetTextureAlphaMod( mTexture, alpha );
 }
 
-void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip )
-{
-	SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip )
+{
+	SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+
+	if( clip != NULL )
+	{
+		renderQuad.w = clip->w;
+		renderQuad.h = clip->h;
+	}
+
+	SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
+}
+
+void LTexture::setAsRenderTarget()
+{
+	SDL_SetRenderTarget( gRenderer, mTexture );
+}
+
+int LTexture::getWidth()
+{
+	return mWidth;
+}
+
+int LTexture::getHeight()
+{
+	return mHeight;
+}
+
+TileMap::TileMap()
+{
+	mColumns = 0;
+	mRows = 0;
+	mSpriteCount = 0;
+	mChunkColumns = 0;
+	mChunkRows = 0;
+
+	mPageTiles = NULL;
+	for( int i = 0; i < TOTAL_CHUNK_PAGES; ++i )
+	{
+		mPageOwners[ i ] = -1;
+		mPageReady[ i ] = false;
+		mPageLastUsed[ i ] = 0;
+	}
+
+	mStreamThread = NULL;
+	mStreamLock = NULL;
+	mStreamCondition = NULL;
+	mStreamQuit = false;
+
+	mRequestFirst = 0;
+	mRequestCount = 0;
+	mLoadedFirst = 0;
+	mLoadedCount = 0;
+
+	for( int i = 0; i < TOTAL_CHUNK_TEXTURES; ++i )
+	{
+		mChunkOwners[ i ] = -1;
+		mChunkDirty[ i ] = true;
+		mChunkLastUsed[ i ] = 0;
+	}
+
+	mFrame = 0;
+}
+
+TileMap::~TileMap()
+{
+	free();
+}
+
+bool TileMap::loadFromFile( std::string path )
+{
+	free();
+
+	SDL_RWops* file = SDL_RWFromFile( path.c_str(), "rb" );
+	if( file == NULL )
+	{
+		printf( "Unable to open level %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+	}
+	else
+	{
+		LevelHeader header;
+
+		if( ( SDL_RWread( file, &header, sizeof( LevelHeader ), 1 ) != 1 ) || ( header.magic != LEVEL_MAGIC ) )
+		{
+			printf( "Error loading level %s: Invalid header!\n", path.c_str() );
+		}
+		else if( ( header.columns <= 0 ) || ( header.rows <= 0 ) || ( header.tileWidth != TILE_WIDTH ) || ( header.tileHeight != TILE_HEIGHT ) || ( header.spriteCount <= 0 ) || ( header.spriteCount > TOTAL_TILE_SPRITES ) )
+		{
+			printf( "Error loading level %s: Level does not match the tile set!\n", path.c_str() );
+		}
+		else if( SDL_RWsize( file ) < (Sint64)sizeof( LevelHeader ) + (Sint64)header.columns * header.rows )
+		{
+			printf( "Error loading level %s: Unexpected end of file!\n", path.c_str() );
+		}
+		else
+		{
+			mPath = path;
+			mColumns = header.columns;
+			mRows = header.rows;
+			mSpriteCount = header.spriteCount;
+			mChunkColumns = ( mColumns + CHUNK_TILES - 1 ) / CHUNK_TILES;
+			mChunkRows = ( mRows + CHUNK_TILES - 1 ) / CHUNK_TILES;
+
+			mPageTiles = new Uint8[ TOTAL_CHUNK_PAGES * CHUNK_TILES * CHUNK_TILES ];
+
+			mStreamLock = SDL_CreateMutex();
+			mStreamCondition = SDL_CreateCond();
+			mStreamQuit = false;
+
+			mStreamThread = SDL_CreateThread( streamThread, "TileStreamer", this );
+			if( mStreamThread == NULL )
+			{
+				printf( "Unable to create streaming thread! SDL Error: %s\n", SDL_GetError() );
+			}
+		}
+
+		SDL_RWclose( file );
+	}
+
+	if( mStreamThread == NULL )
+	{
+		free();
+	}
+
+	return mStreamThread != NULL;
+}
+
+void TileMap::free()
+{
+	if( mStreamThread != NULL )
+	{
+		SDL_LockMutex( mStreamLock );
+		mStreamQuit = true;
+		SDL_CondSignal( mStreamCondition );
+		SDL_UnlockMutex( mStreamLock );
+
+		SDL_WaitThread( mStreamThread, NULL );
+		mStreamThread = NULL;
+	}
+
+	if( mStreamCondition != NULL )
+	{
+		SDL_DestroyCond( mStreamCondition );
+		mStreamCondition = NULL;
+	}
+
+	if( mStreamLock != NULL )
+	{
+		SDL_DestroyMutex( mStreamLock );
+		mStreamLock = NULL;
+	}
+
+	mRequestFirst = 0;
+	mRequestCount = 0;
+	mLoadedFirst = 0;
+	mLoadedCount = 0;
+
+	for( int i = 0; i < TOTAL_CHUNK_TEXTURES; ++i )
+	{
+		mChunkTextures[ i ].free();
+		mChunkOwners[ i ] = -1;
+		mChunkDirty[ i ] = true;
+		mChunkLastUsed[ i ] = 0;
+	}
+
+	for( int i = 0; i < TOTAL_CHUNK_PAGES; ++i )
+	{
+		mPageOwners[ i ] = -1;
+		mPageReady[ i ] = false;
+		mPageLastUsed[ i ] = 0;
+	}
+
+	if( mPageTiles != NULL )
+	{
+		delete[] mPageTiles;
+		mPageTiles = NULL;
+		mColumns = 0;
+		mRows = 0;
+		mSpriteCount = 0;
+		mChunkColumns = 0;
+		mChunkRows = 0;
+	}
+}
+
+void TileMap::streamChunks( SDL_Rect& camera )
+{
+	++mFrame;
+
+	SDL_LockMutex( mStreamLock );
+	while( mLoadedCount > 0 )
+	{
+		mPageReady[ mLoaded[ mLoadedFirst ].page ] = true;
+
+		for( int i = 0; i < TOTAL_CHUNK_TEXTURES; ++i )
+		{
+			if( mChunkOwners[ i ] == mLoaded[ mLoadedFirst ].chunk )
+			{
+				mChunkDirty[ i ] = true;
+			}
+		}
+
+		mLoadedFirst = ( mLoadedFirst + 1 ) % TOTAL_CHUNK_PAGES;
+		--mLoadedCount;
+	}
+	SDL_UnlockMutex( mStreamLock );
+
+	int firstColumn, lastColumn, firstRow, lastRow;
+	getTileRange( camera, firstColumn, lastColumn, firstRow, lastRow );
+
+	int firstChunkColumn = SDL_max( firstColumn / CHUNK_TILES - CHUNK_STREAM_MARGIN, 0 );
+	int lastChunkColumn = SDL_min( lastColumn / CHUNK_TILES + CHUNK_STREAM_MARGIN, mChunkColumns - 1 );
+	int firstChunkRow = SDL_max( firstRow / CHUNK_TILES - CHUNK_STREAM_MARGIN, 0 );
+	int lastChunkRow = SDL_min( lastRow / CHUNK_TILES + CHUNK_STREAM_MARGIN, mChunkRows - 1 );
+
+	for( int chunkRow = firstChunkRow; chunkRow <= lastChunkRow; ++chunkRow )
+	{
+		for( int chunkColumn = firstChunkColumn; chunkColumn <= lastChunkColumn; ++chunkColumn )
+		{
+			requestChunk( chunkRow * mChunkColumns + chunkColumn );
+		}
+	}
+}
+
+void TileMap::render( SDL_Rect& camera )
+{
+	int firstColumn, lastColumn, firstRow, lastRow;
+	getTileRange( camera, firstColumn, lastColumn, firstRow, lastRow );
+
+	for( int chunkRow = firstRow / CHUNK_TILES; chunkRow <= lastRow / CHUNK_TILES; ++chunkRow )
+	{
+		for( int chunkColumn = firstColumn / CHUNK_TILES; chunkColumn <= lastColumn / CHUNK_TILES; ++chunkColumn )
+		{
+			int chunk = chunkRow * mChunkColumns + chunkColumn;
+
+			int page = getPage( chunk );
+			if( page != -1 )
+			{
+				int slot = getChunkSlot( chunk );
+
+				if( mChunkDirty[ slot ] )
+				{
+					bakeChunk( slot, &mPageTiles[ page * CHUNK_TILES * CHUNK_TILES ] );
+				}
+
+				mChunkTextures[ slot ].render( chunkColumn * CHUNK_TILES * TILE_WIDTH - camera.x, chunkRow * CHUNK_TILES * TILE_HEIGHT - camera.y );
+			}
+		}
+	}
+}
+
+int TileMap::getType( int column, int row )
+{
+	int page = getPage( ( row / CHUNK_TILES ) * mChunkColumns + column / CHUNK_TILES );
+	if( page == -1 )
+	{
+		return -1;
+	}
+
+	return mPageTiles[ page * CHUNK_TILES * CHUNK_TILES + ( row % CHUNK_TILES ) * CHUNK_TILES + column % CHUNK_TILES ];
+}
+
+void TileMap::setType( int column, int row, int tileType )
+{
+	int chunk = ( row / CHUNK_TILES ) * mChunkColumns + column / CHUNK_TILES;
+
+	int page = getPage( chunk );
+	if( page == -1 )
+	{
+		return;
+	}
+
+	Uint8* tile = &mPageTiles[ page * CHUNK_TILES * CHUNK_TILES + ( row % CHUNK_TILES ) * CHUNK_TILES + column % CHUNK_TILES ];
+	if( *tile != tileType )
+	{
+		*tile = (Uint8)tileType;
+
+		for( int i = 0; i < TOTAL_CHUNK_TEXTURES; ++i )
+		{
+			if( mChunkOwners[ i ] == chunk )
+			{
+				mChunkDirty[ i ] = true;
+			}
+		}
+	}
+}
+
+SDL_Rect TileMap::getBox( int column, int row )
+{
+	SDL_Rect box = { column * TILE_WIDTH, row * TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT };
+	return box;
+}
+
+void TileMap::getTileRange( SDL_Rect box, int& firstColumn, int& lastColumn, int& firstRow, int& lastRow )
+{
+	firstColumn = box.x / TILE_WIDTH;
+	lastColumn = ( box.x + box.w - 1 ) / TILE_WIDTH;
+	firstRow = box.y / TILE_HEIGHT;
+	lastRow = ( box.y + box.h - 1 ) / TILE_HEIGHT;
+
+	if( firstColumn < 0 )
+	{
+		firstColumn = 0;
+	}
+	if( firstRow < 0 )
+	{
+		firstRow = 0;
+	}
+	if( lastColumn > mColumns - 1 )
+	{
+		lastColumn = mColumns - 1;
+	}
+	if( lastRow > mRows - 1 )
+	{
+		lastRow = mRows - 1;
+	}
+}
+
+int TileMap::streamThread( void* data )
+{
+	return ( (TileMap*)data )->streamLoop();
+}
+
+int TileMap::streamLoop()
+{
+	SDL_RWops* file = SDL_RWFromFile( mPath.c_str(), "rb" );
+	if( file == NULL )
+	{
+		printf( "Unable to open level %s for streaming! SDL Error: %s\n", mPath.c_str(), SDL_GetError() );
+	}
+
+	SDL_LockMutex( mStreamLock );
+
+	while( !mStreamQuit )
+	{
+		if( mRequestCount == 0 )
+		{
+			SDL_CondWait( mStreamCondition, mStreamLock );
+			continue;
+		}
+
+		ChunkRequest request = mRequests[ mRequestFirst ];
+		mRequestFirst = ( mRequestFirst + 1 ) % TOTAL_CHUNK_PAGES;
+		--mRequestCount;
+
+		SDL_UnlockMutex( mStreamLock );
+
+		readChunk( file, request.chunk, &mPageTiles[ request.page * CHUNK_TILES * CHUNK_TILES ] );
+
+		SDL_LockMutex( mStreamLock );
+
+		mLoaded[ ( mLoadedFirst + mLoadedCount ) % TOTAL_CHUNK_PAGES ] = request;
+		++mLoadedCount;
+	}
+
+	SDL_UnlockMutex( mStreamLock );
+
+	if( file != NULL )
+	{
+		SDL_RWclose( file );
+	}
+
+	return 0;
+}
+
+void TileMap::readChunk( SDL_RWops* file, int chunk, Uint8* tiles )
+{
+	int firstColumn = ( chunk % mChunkColumns ) * CHUNK_TILES;
+	int firstRow = ( chunk / mChunkColumns ) * CHUNK_TILES;
+	int columns = SDL_min( CHUNK_TILES, mColumns - firstColumn );
+	int rows = SDL_min( CHUNK_TILES, mRows - firstRow );
+
+	memset( tiles, 0, CHUNK_TILES * CHUNK_TILES );
+
+	for( int row = 0; row < rows; ++row )
+	{
+		Sint64 offset = (Sint64)sizeof( LevelHeader ) + (Sint64)( firstRow + row ) * mColumns + firstColumn;
+
+		if( ( file == NULL ) || ( SDL_RWseek( file, offset, RW_SEEK_SET ) < 0 ) || ( SDL_RWread( file, &tiles[ row * CHUNK_TILES ], 1, columns ) != (size_t)columns ) )
+		{
+			printf( "Error streaming level chunk %d!\n", chunk );
+			memset( tiles, 0, CHUNK_TILES * CHUNK_TILES );
+			break;
+		}
+	}
+
+	int invalidTiles = 0;
+	for( int i = 0; i < CHUNK_TILES * CHUNK_TILES; ++i )
+	{
+		if( tiles[ i ] >= mSpriteCount )
+		{
+			tiles[ i ] = 0;
+			++invalidTiles;
+		}
+	}
+
+	if( invalidTiles > 0 )
+	{
+		printf( "Error streaming level chunk %d: %d invalid tile types!\n", chunk, invalidTiles );
+	}
+}
+
+void TileMap::requestChunk( int chunk )
+{
+	int page = -1;
+
+	for( int i = 0; i < TOTAL_CHUNK_PAGES; ++i )
+	{
+		if( mPageOwners[ i ] == chunk )
+		{
+			mPageLastUsed[ i ] = mFrame;
+			return;
+		}
+
+		if( ( mPageOwners[ i ] == -1 ) || mPageReady[ i ] )
+		{
+			if( ( mPageLastUsed[ i ] != mFrame ) && ( ( page == -1 ) || ( mPageLastUsed[ i ] < mPageLastUsed[ page ] ) ) )
+			{
+				page = i;
+			}
+		}
+	}
+
+	if( page != -1 )
+	{
+		mPageOwners[ page ] = chunk;
+		mPageReady[ page ] = false;
+		mPageLastUsed[ page ] = mFrame;
+
+		ChunkRequest request = { page, chunk };
+
+		SDL_LockMutex( mStreamLock );
+		mRequests[ ( mRequestFirst + mRequestCount ) % TOTAL_CHUNK_PAGES ] = request;
+		++mRequestCount;
+		SDL_CondSignal( mStreamCondition );
+		SDL_UnlockMutex( mStreamLock );
+	}
+}
+
+int TileMap::getPage( int chunk )
+{
+	for( int i = 0; i < TOTAL_CHUNK_PAGES; ++i )
+	{
+		if( ( mPageOwners[ i ] == chunk ) && mPageReady[ i ] )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int TileMap::getChunkSlot( int chunk )
+{
+	int slot = 0;
+
+	for( int i = 0; i < TOTAL_CHUNK_TEXTURES; ++i )
+	{
+		if( mChunkOwners[ i ] == chunk )
+		{
+			slot = i;
+			break;
+		}
+
+		if( mChunkLastUsed[ i ] < mChunkLastUsed[ slot ] )
+		{
+			slot = i;
+		}
+	}
+
+	if( mChunkOwners[ slot ] != chunk )
+	{
+		mChunkOwners[ slot ] = chunk;
+		mChunkDirty[ slot ] = true;
+	}
+
+	mChunkLastUsed[ slot ] = mFrame;
+
+	return slot;
+}
+
+void TileMap::bakeChunk( int slot, Uint8* tiles )
+{
+	LTexture& chunkTexture = mChunkTextures[ slot ];
+
+	if( chunkTexture.getWidth() == 0 )
+	{
+		if( !chunkTexture.createBlank( CHUNK_TILES * TILE_WIDTH, CHUNK_TILES * TILE_HEIGHT, SDL_TEXTUREACCESS_TARGET ) )
+		{
+			printf( "Failed to create chunk texture!\n" );
+			return;
+		}
+
+		chunkTexture.setBlendMode( gPremultipliedBlend );
+	}
+
+	int firstColumn = ( mChunkOwners[ slot ] % mChunkColumns ) * CHUNK_TILES;
+	int firstRow = ( mChunkOwners[ slot ] / mChunkColumns ) * CHUNK_TILES;
+	int columns = SDL_min( CHUNK_TILES, mColumns - firstColumn );
+	int rows = SDL_min( CHUNK_TILES, mRows - firstRow );
 
-	if( clip != NULL )
+	chunkTexture.setAsRenderTarget();
+
+	SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0x00 );
+	SDL_RenderClear( gRenderer );
+
+	for( int row = 0; row < rows; ++row )
 	{
-		renderQuad.w = clip->w;
-		renderQuad.h = clip->h;
+		for( int column = 0; column < columns; ++column )
+		{
+			gTileTexture.render( column * TILE_WIDTH, row * TILE_HEIGHT, &gTileClips[ tiles[ row * CHUNK_TILES + column ] ] );
+		}
 	}
 
-	SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
-}
-
-int LTexture::getWidth()
-{
-	return mWidth;
-}
+	SDL_SetRenderTarget( gRenderer, NULL );
 
-int LTexture::getHeight()
-{
-	return mHeight;
+	mChunkDirty[ slot ] = false;
 }
 
-Tile::Tile( int x, int y, int tileType )
+int TileMap::getColumns()
 {
-    mBox.x = x;
-    mBox.y = y;
-
-    mBox.w = TILE_WIDTH;
-    mBox.h = TILE_HEIGHT;
-
-    mType = tileType;
+	return mColumns;
 }
 
-void Tile::render( SDL_Rect& camera )
+int TileMap::getRows()
 {
-    if( checkCollision( camera, mBox ) )
-    {
-        gTileTexture.render( mBox.x - camera.x, mBox.y - camera.y, &gTileClips[ mType ] );
-    }
+	return mRows;
 }
 
-int Tile::getType()
+int TileMap::getWidth()
 {
-    return mType;
+	return mColumns * TILE_WIDTH;
 }
 
-SDL_Rect Tile::getBox()
+int TileMap::getHeight()
 {
-    return mBox;
+	return mRows * TILE_HEIGHT;
 }
 
 Dot::Dot()
@@ -311,24 +981,24 @@ void Dot::handleEvent( SDL_Event& e )
     }
 }
 
-void Dot::move( Tile *tiles[] )
+void Dot::move( TileMap& tiles )
 {
     mBox.x += mVelX;
 
-    if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > LEVEL_WIDTH ) || touchesWall( mBox, tiles ) )
+    if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > tiles.getWidth() ) || touchesWall( mBox, tiles ) )
     {
         mBox.x -= mVelX;
     }
 
     mBox.y += mVelY;
 
-    if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > LEVEL_HEIGHT ) || touchesWall( mBox, tiles ) )
+    if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > tiles.getHeight() ) || touchesWall( mBox, tiles ) )
     {
         mBox.y -= mVelY;
     }
 }
 
-void Dot::setCamera( SDL_Rect& camera )
+void Dot::setCamera( SDL_Rect& camera, TileMap& tiles )
 {
 	camera.x = ( mBox.x + DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
 	camera.y = ( mBox.y + DOT_HEIGHT / 2 ) - SCREEN_HEIGHT / 2;
@@ -341,13 +1011,13 @@ void Dot::setCamera( SDL_Rect& camera )
 	{
 		camera.y = 0;
 	}
-	if( camera.x > LEVEL_WIDTH - camera.w )
+	if( camera.x > tiles.getWidth() - camera.w )
 	{
-		camera.x = LEVEL_WIDTH - camera.w;
+		camera.x = tiles.getWidth() - camera.w;
 	}
-	if( camera.y > LEVEL_HEIGHT - camera.h )
+	if( camera.y > tiles.getHeight() - camera.h )
 	{
-		camera.y = LEVEL_HEIGHT - camera.h;
+		camera.y = tiles.getHeight() - camera.h;
 	}
 }
 
@@ -390,6 +1060,8 @@ bool init()
 			{
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 
+				gPremultipliedBlend = SDL_ComposeCustomBlendMode( SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD );
+
 				int imgFlags = IMG_INIT_PNG;
 				if( !( IMG_Init( imgFlags ) & imgFlags ) )
 				{
@@ -403,20 +1075,19 @@ bool init()
 	return success;
 }
 
-bool loadMedia( Tile* tiles[] )
+bool loadMedia( TileMap& tiles )
 {
 	bool success = true;
 
-	if( !gDotTexture.loadFromFile( "39_tiling/dot.bmp" ) )
+	if( !loadPack( "39_tiling/media.pak" ) )
 	{
-		printf( "Failed to load dot texture!\n" );
-		success = false;
-	}
+		printf( "Warning: Cooking media pack!\n" );
 
-	if( !gTileTexture.loadFromFile( "39_tiling/tiles.png" ) )
-	{
-		printf( "Failed to load tile set texture!\n" );
-		success = false;
+		if( !cookPack( "39_tiling/media.pak" ) || !loadPack( "39_tiling/media.pak" ) )
+		{
+			printf( "Failed to load media pack!\n" );
+			success = false;
+		}
 	}
 
 	if( !setTiles( tiles ) )
@@ -428,16 +1099,9 @@ bool loadMedia( Tile* tiles[] )
 	return success;
 }
 
-void close( Tile* tiles[] )
+void close( TileMap& tiles )
 {
-	for( int i = 0; i < TOTAL_TILES; ++i )
-	{
-		 if( tiles[ i ] == NULL )
-		 {
-			delete tiles[ i ];
-			tiles[ i ] = NULL;
-		 }
-	}
+	tiles.free();
 
 	gDotTexture.free();
 	gTileTexture.free();
@@ -491,18 +1155,18 @@ bool checkCollision( SDL_Rect a, SDL_Rect b )
     return true;
 }
 
-bool setTiles( Tile* tiles[] )
+bool convertMap( std::string mapPath, std::string levelPath )
 {
-	bool tilesLoaded = true;
+	bool mapConverted = true;
 
-    int x = 0, y = 0;
+	Uint8 tileTypes[ TOTAL_TILES ];
 
-    std::ifstream map( "39_tiling/lazy.map" );
+    std::ifstream map( mapPath.c_str() );
 
     if( !map )
     {
 		printf( "Unable to load map file!\n" );
-		tilesLoaded = false;
+		mapConverted = false;
     }
 	else
 	{
@@ -515,109 +1179,343 @@ bool setTiles( Tile* tiles[] )
 			if( map.fail() )
 			{
 				printf( "Error loading map: Unexpected end of file!\n" );
-				tilesLoaded = false;
+				mapConverted = false;
 				break;
 			}
 
 			if( ( tileType >= 0 ) && ( tileType < TOTAL_TILE_SPRITES ) )
 			{
-				tiles[ i ] = new Tile( x, y, tileType );
+				tileTypes[ i ] = (Uint8)tileType;
 			}
 			else
 			{
 				printf( "Error loading map: Invalid tile type at %d!\n", i );
-				tilesLoaded = false;
+				mapConverted = false;
 				break;
 			}
+		}
+	}
+
+    map.close();
+
+	if( mapConverted )
+	{
+		SDL_RWops* file = SDL_RWFromFile( levelPath.c_str(), "wb" );
+		if( file == NULL )
+		{
+			printf( "Error: Unable to create level file! SDL Error: %s\n", SDL_GetError() );
+			mapConverted = false;
+		}
+		else
+		{
+			LevelHeader header = { LEVEL_MAGIC, LEVEL_COLUMNS, LEVEL_ROWS, TILE_WIDTH, TILE_HEIGHT, TOTAL_TILE_SPRITES };
+
+			if( ( SDL_RWwrite( file, &header, sizeof( LevelHeader ), 1 ) != 1 ) || ( SDL_RWwrite( file, tileTypes, 1, TOTAL_TILES ) != TOTAL_TILES ) )
+			{
+				printf( "Error: Unable to write level file! SDL Error: %s\n", SDL_GetError() );
+				mapConverted = false;
+			}
+
+			SDL_RWclose( file );
+		}
+	}
+
+	return mapConverted;
+}
+
+bool setTiles( TileMap& tiles )
+{
+	bool tilesLoaded = true;
+
+	if( !tiles.loadFromFile( "39_tiling/lazy.lvl" ) )
+	{
+		printf( "Warning: Converting text map to binary level!\n" );
+
+		if( !convertMap( "39_tiling/lazy.map", "39_tiling/lazy.lvl" ) || !tiles.loadFromFile( "39_tiling/lazy.lvl" ) )
+		{
+			tilesLoaded = false;
+		}
+	}
+
+    return tilesLoaded;
+}
+
+void setTileClips()
+{
+	gTileClips[ TILE_RED ].x = 0;
+	gTileClips[ TILE_RED ].y = 0;
+	gTileClips[ TILE_RED ].w = TILE_WIDTH;
+	gTileClips[ TILE_RED ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_GREEN ].x = 0;
+	gTileClips[ TILE_GREEN ].y = 80;
+	gTileClips[ TILE_GREEN ].w = TILE_WIDTH;
+	gTileClips[ TILE_GREEN ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_BLUE ].x = 0;
+	gTileClips[ TILE_BLUE ].y = 160;
+	gTileClips[ TILE_BLUE ].w = TILE_WIDTH;
+	gTileClips[ TILE_BLUE ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_TOPLEFT ].x = 80;
+	gTileClips[ TILE_TOPLEFT ].y = 0;
+	gTileClips[ TILE_TOPLEFT ].w = TILE_WIDTH;
+	gTileClips[ TILE_TOPLEFT ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_LEFT ].x = 80;
+	gTileClips[ TILE_LEFT ].y = 80;
+	gTileClips[ TILE_LEFT ].w = TILE_WIDTH;
+	gTileClips[ TILE_LEFT ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_BOTTOMLEFT ].x = 80;
+	gTileClips[ TILE_BOTTOMLEFT ].y = 160;
+	gTileClips[ TILE_BOTTOMLEFT ].w = TILE_WIDTH;
+	gTileClips[ TILE_BOTTOMLEFT ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_TOP ].x = 160;
+	gTileClips[ TILE_TOP ].y = 0;
+	gTileClips[ TILE_TOP ].w = TILE_WIDTH;
+	gTileClips[ TILE_TOP ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_CENTER ].x = 160;
+	gTileClips[ TILE_CENTER ].y = 80;
+	gTileClips[ TILE_CENTER ].w = TILE_WIDTH;
+	gTileClips[ TILE_CENTER ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_BOTTOM ].x = 160;
+	gTileClips[ TILE_BOTTOM ].y = 160;
+	gTileClips[ TILE_BOTTOM ].w = TILE_WIDTH;
+	gTileClips[ TILE_BOTTOM ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_TOPRIGHT ].x = 240;
+	gTileClips[ TILE_TOPRIGHT ].y = 0;
+	gTileClips[ TILE_TOPRIGHT ].w = TILE_WIDTH;
+	gTileClips[ TILE_TOPRIGHT ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_RIGHT ].x = 240;
+	gTileClips[ TILE_RIGHT ].y = 80;
+	gTileClips[ TILE_RIGHT ].w = TILE_WIDTH;
+	gTileClips[ TILE_RIGHT ].h = TILE_HEIGHT;
+
+	gTileClips[ TILE_BOTTOMRIGHT ].x = 240;
+	gTileClips[ TILE_BOTTOMRIGHT ].y = 160;
+	gTileClips[ TILE_BOTTOMRIGHT ].w = TILE_WIDTH;
+	gTileClips[ TILE_BOTTOMRIGHT ].h = TILE_HEIGHT;
+}
 
-			x += TILE_WIDTH;
+SDL_Surface* cookSurface( std::string path )
+{
+	SDL_Surface* formattedSurface = NULL;
+
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+	}
+	else
+	{
+		SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
 
-			if( x >= LEVEL_WIDTH )
+		formattedSurface = SDL_ConvertSurfaceFormat( loadedSurface, PACK_PIXEL_FORMAT, NULL );
+		if( formattedSurface == NULL )
+		{
+			printf( "Unable to convert loaded surface %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+		}
+		else
+		{
+			for( int y = 0; y < formattedSurface->h; ++y )
 			{
-				x = 0;
+				Uint32* row = (Uint32*)( (Uint8*)formattedSurface->pixels + y * formattedSurface->pitch );
+
+				for( int x = 0; x < formattedSurface->w; ++x )
+				{
+					Uint8 r, g, b, a;
+					SDL_GetRGBA( row[ x ], formattedSurface->format, &r, &g, &b, &a );
 
-				y += TILE_HEIGHT;
+					row[ x ] = SDL_MapRGBA( formattedSurface->format, r * a / 255, g * a / 255, b * a / 255, a );
+				}
 			}
 		}
-		
-		if( tilesLoaded )
-		{
-			gTileClips[ TILE_RED ].x = 0;
-			gTileClips[ TILE_RED ].y = 0;
-			gTileClips[ TILE_RED ].w = TILE_WIDTH;
-			gTileClips[ TILE_RED ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_GREEN ].x = 0;
-			gTileClips[ TILE_GREEN ].y = 80;
-			gTileClips[ TILE_GREEN ].w = TILE_WIDTH;
-			gTileClips[ TILE_GREEN ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BLUE ].x = 0;
-			gTileClips[ TILE_BLUE ].y = 160;
-			gTileClips[ TILE_BLUE ].w = TILE_WIDTH;
-			gTileClips[ TILE_BLUE ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOPLEFT ].x = 80;
-			gTileClips[ TILE_TOPLEFT ].y = 0;
-			gTileClips[ TILE_TOPLEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOPLEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_LEFT ].x = 80;
-			gTileClips[ TILE_LEFT ].y = 80;
-			gTileClips[ TILE_LEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_LEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOMLEFT ].x = 80;
-			gTileClips[ TILE_BOTTOMLEFT ].y = 160;
-			gTileClips[ TILE_BOTTOMLEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOMLEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOP ].x = 160;
-			gTileClips[ TILE_TOP ].y = 0;
-			gTileClips[ TILE_TOP ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOP ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_CENTER ].x = 160;
-			gTileClips[ TILE_CENTER ].y = 80;
-			gTileClips[ TILE_CENTER ].w = TILE_WIDTH;
-			gTileClips[ TILE_CENTER ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOM ].x = 160;
-			gTileClips[ TILE_BOTTOM ].y = 160;
-			gTileClips[ TILE_BOTTOM ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOM ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOPRIGHT ].x = 240;
-			gTileClips[ TILE_TOPRIGHT ].y = 0;
-			gTileClips[ TILE_TOPRIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOPRIGHT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_RIGHT ].x = 240;
-			gTileClips[ TILE_RIGHT ].y = 80;
-			gTileClips[ TILE_RIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_RIGHT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOMRIGHT ].x = 240;
-			gTileClips[ TILE_BOTTOMRIGHT ].y = 160;
-			gTileClips[ TILE_BOTTOMRIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOMRIGHT ].h = TILE_HEIGHT;
+
+		SDL_FreeSurface( loadedSurface );
+	}
+
+	return formattedSurface;
+}
+
+bool cookPack( std::string packPath )
+{
+	bool packCooked = true;
+
+	std::string imagePaths[ TOTAL_PACK_IMAGES ] = { "39_tiling/dot.bmp", "39_tiling/tiles.png" };
+	SDL_Surface* surfaces[ TOTAL_PACK_IMAGES ] = { NULL, NULL };
+
+	for( int i = 0; i < TOTAL_PACK_IMAGES; ++i )
+	{
+		surfaces[ i ] = cookSurface( imagePaths[ i ] );
+		if( surfaces[ i ] == NULL )
+		{
+			packCooked = false;
 		}
 	}
 
-    map.close();
+	setTileClips();
 
-    return tilesLoaded;
+	if( packCooked )
+	{
+		PackHeader header = { PACK_MAGIC, PACK_PIXEL_FORMAT, TOTAL_PACK_IMAGES, TOTAL_TILE_SPRITES };
+		PackImage images[ TOTAL_PACK_IMAGES ];
+
+		int pixelOffset = sizeof( PackHeader ) + sizeof( images ) + sizeof( gTileClips );
+		for( int i = 0; i < TOTAL_PACK_IMAGES; ++i )
+		{
+			images[ i ].width = surfaces[ i ]->w;
+			images[ i ].height = surfaces[ i ]->h;
+			images[ i ].pitch = surfaces[ i ]->w * 4;
+			images[ i ].pixelOffset = pixelOffset;
+			images[ i ].firstClip = 0;
+			images[ i ].clipCount = i == PACK_IMAGE_TILES ? TOTAL_TILE_SPRITES : 0;
+
+			pixelOffset += images[ i ].pitch * images[ i ].height;
+		}
+
+		SDL_RWops* file = SDL_RWFromFile( packPath.c_str(), "wb" );
+		if( file == NULL )
+		{
+			printf( "Error: Unable to create media pack! SDL Error: %s\n", SDL_GetError() );
+			packCooked = false;
+		}
+		else
+		{
+			if( ( SDL_RWwrite( file, &header, sizeof( PackHeader ), 1 ) != 1 ) || ( SDL_RWwrite( file, images, sizeof( images ), 1 ) != 1 ) || ( SDL_RWwrite( file, gTileClips, sizeof( gTileClips ), 1 ) != 1 ) )
+			{
+				packCooked = false;
+			}
+
+			for( int i = 0; i < TOTAL_PACK_IMAGES && packCooked; ++i )
+			{
+				for( int y = 0; y < images[ i ].height; ++y )
+				{
+					if( SDL_RWwrite( file, (Uint8*)surfaces[ i ]->pixels + y * surfaces[ i ]->pitch, images[ i ].pitch, 1 ) != 1 )
+					{
+						packCooked = false;
+						break;
+					}
+				}
+			}
+
+			if( !packCooked )
+			{
+				printf( "Error: Unable to write media pack! SDL Error: %s\n", SDL_GetError() );
+			}
+
+			SDL_RWclose( file );
+		}
+	}
+
+	for( int i = 0; i < TOTAL_PACK_IMAGES; ++i )
+	{
+		SDL_FreeSurface( surfaces[ i ] );
+	}
+
+	return packCooked;
+}
+
+bool loadPack( std::string packPath )
+{
+	bool packLoaded = true;
+
+	SDL_RWops* file = SDL_RWFromFile( packPath.c_str(), "rb" );
+	if( file == NULL )
+	{
+		return false;
+	}
+
+	Sint64 packSize = SDL_RWsize( file );
+	Uint8* pack = NULL;
+
+	if( packSize < (Sint64)sizeof( PackHeader ) )
+	{
+		packLoaded = false;
+	}
+	else
+	{
+		pack = new Uint8[ (size_t)packSize ];
+		if( SDL_RWread( file, pack, (size_t)packSize, 1 ) != 1 )
+		{
+			packLoaded = false;
+		}
+	}
+
+	SDL_RWclose( file );
+
+	PackHeader* header = (PackHeader*)pack;
+	PackImage* images = NULL;
+	SDL_Rect* clips = NULL;
+
+	if( packLoaded )
+	{
+		images = (PackImage*)( pack + sizeof( PackHeader ) );
+		clips = (SDL_Rect*)( images + TOTAL_PACK_IMAGES );
+
+		if( ( header->magic != PACK_MAGIC ) || ( header->imageCount != TOTAL_PACK_IMAGES ) || ( header->clipCount != TOTAL_TILE_SPRITES ) || ( (Sint64)( (Uint8*)( clips + TOTAL_TILE_SPRITES ) - pack ) > packSize ) )
+		{
+			packLoaded = false;
+		}
+	}
+
+	for( int i = 0; i < TOTAL_PACK_IMAGES && packLoaded; ++i )
+	{
+		if( ( images[ i ].pixelOffset < 0 ) || ( images[ i ].pitch < images[ i ].width * 4 ) || ( images[ i ].firstClip < 0 ) || ( (Sint64)images[ i ].pixelOffset + (Sint64)images[ i ].pitch * images[ i ].height > packSize ) || ( images[ i ].firstClip + images[ i ].clipCount > header->clipCount ) )
+		{
+			packLoaded = false;
+		}
+	}
+
+	if( !packLoaded )
+	{
+		printf( "Unable to read media pack %s!\n", packPath.c_str() );
+	}
+	else
+	{
+		LTexture* textures[ TOTAL_PACK_IMAGES ] = { &gDotTexture, &gTileTexture };
+
+		for( int i = 0; i < TOTAL_PACK_IMAGES; ++i )
+		{
+			if( !textures[ i ]->loadFromPixels( pack + images[ i ].pixelOffset, images[ i ].width, images[ i ].height, images[ i ].pitch, header->pixelFormat ) )
+			{
+				packLoaded = false;
+			}
+		}
+
+		for( int i = 0; i < images[ PACK_IMAGE_TILES ].clipCount; ++i )
+		{
+			gTileClips[ i ] = clips[ images[ PACK_IMAGE_TILES ].firstClip + i ];
+		}
+	}
+
+	delete[] pack;
+
+	return packLoaded;
 }
 
-bool touchesWall( SDL_Rect box, Tile* tiles[] )
+bool touchesWall( SDL_Rect box, TileMap& tiles )
 {
-    for( int i = 0; i < TOTAL_TILES; ++i )
+	int firstColumn, lastColumn, firstRow, lastRow;
+	tiles.getTileRange( box, firstColumn, lastColumn, firstRow, lastRow );
+
+    for( int row = firstRow; row <= lastRow; ++row )
     {
-        if( ( tiles[ i ]->getType() >= TILE_CENTER ) && ( tiles[ i ]->getType() <= TILE_TOPLEFT ) )
+        for( int column = firstColumn; column <= lastColumn; ++column )
         {
-            if( checkCollision( box, tiles[ i ]->getBox() ) )
+            int tileType = tiles.getType( column, row );
+
+            if( ( tileType < 0 ) || ( ( tileType >= TILE_CENTER ) && ( tileType <= TILE_TOPLEFT ) ) )
             {
-                return true;
+                if( checkCollision( box, tiles.getBox( column, row ) ) )
+                {
+                    return true;
+                }
             }
         }
     }
@@ -625,6 +1523,156 @@ bool touchesWall( SDL_Rect box, Tile* tiles[] )
     return false;
 }
 
+bool writeBenchmarkLevel( std::string levelPath, int columns, int rows )
+{
+	bool levelWritten = true;
+
+	SDL_RWops* file = SDL_RWFromFile( levelPath.c_str(), "wb" );
+	if( file == NULL )
+	{
+		printf( "Error: Unable to create level file! SDL Error: %s\n", SDL_GetError() );
+		return false;
+	}
+
+	LevelHeader header = { LEVEL_MAGIC, columns, rows, TILE_WIDTH, TILE_HEIGHT, TOTAL_TILE_SPRITES };
+	if( SDL_RWwrite( file, &header, sizeof( LevelHeader ), 1 ) != 1 )
+	{
+		levelWritten = false;
+	}
+
+	Uint8* tileTypes = new Uint8[ columns ];
+	for( int row = 0; row < rows && levelWritten; ++row )
+	{
+		for( int column = 0; column < columns; ++column )
+		{
+			tileTypes[ column ] = ( ( column % 7 == 0 ) || ( row % 5 == 0 ) ) ? TILE_CENTER : TILE_RED + ( column + row ) % 3;
+		}
+
+		if( SDL_RWwrite( file, tileTypes, 1, columns ) != (size_t)columns )
+		{
+			levelWritten = false;
+		}
+	}
+	delete[] tileTypes;
+
+	if( !levelWritten )
+	{
+		printf( "Error: Unable to write level file! SDL Error: %s\n", SDL_GetError() );
+	}
+
+	SDL_RWclose( file );
+
+	return levelWritten;
+}
+
+void benchmarkLevels()
+{
+	char* prefPath = SDL_GetPrefPath( "Lazy Foo' Productions", "39_tiling" );
+	if( prefPath == NULL )
+	{
+		printf( "Unable to find a writable benchmark directory! SDL Error: %s\n", SDL_GetError() );
+		return;
+	}
+
+	std::string levelPath = std::string( prefPath ) + "benchmark.lvl";
+	SDL_free( prefPath );
+
+	for( int level = 0; level < TOTAL_BENCHMARK_LEVELS; ++level )
+	{
+		int side = BENCHMARK_LEVEL_SIDES[ level ];
+
+		TileMap tiles;
+		if( !writeBenchmarkLevel( levelPath, side, side ) || !tiles.loadFromFile( levelPath ) )
+		{
+			printf( "Unable to create %dx%d benchmark level!\n", side, side );
+			continue;
+		}
+
+		SDL_Rect camera = { ( tiles.getWidth() - SCREEN_WIDTH ) / 2, ( tiles.getHeight() - SCREEN_HEIGHT ) / 2, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+		int firstColumn, lastColumn, firstRow, lastRow;
+		tiles.getTileRange( camera, firstColumn, lastColumn, firstRow, lastRow );
+		for( int i = 0; i < 1000; ++i )
+		{
+			tiles.streamChunks( camera );
+			if( ( tiles.getType( firstColumn, firstRow ) != -1 ) && ( tiles.getType( lastColumn, firstRow ) != -1 ) && ( tiles.getType( firstColumn, lastRow ) != -1 ) && ( tiles.getType( lastColumn, lastRow ) != -1 ) )
+			{
+				break;
+			}
+			SDL_Delay( 1 );
+		}
+
+		int hits = 0;
+		Uint64 start = SDL_GetPerformanceCounter();
+		for( int i = 0; i < BENCHMARK_QUERIES; ++i )
+		{
+			SDL_Rect box = { camera.x + ( i * 7919 ) % ( camera.w - Dot::DOT_WIDTH ), camera.y + ( i * 104729 ) % ( camera.h - Dot::DOT_HEIGHT ), Dot::DOT_WIDTH, Dot::DOT_HEIGHT };
+			if( touchesWall( box, tiles ) )
+			{
+				++hits;
+			}
+		}
+		double queryTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_QUERIES;
+
+		int scanHits = 0;
+		start = SDL_GetPerformanceCounter();
+		for( int i = 0; i < BENCHMARK_SCAN_QUERIES; ++i )
+		{
+			SDL_Rect box = { camera.x + ( i * 7919 ) % ( camera.w - Dot::DOT_WIDTH ), camera.y + ( i * 104729 ) % ( camera.h - Dot::DOT_HEIGHT ), Dot::DOT_WIDTH, Dot::DOT_HEIGHT };
+			bool touched = false;
+			for( int row = 0; row < tiles.getRows() && !touched; ++row )
+			{
+				for( int column = 0; column < tiles.getColumns() && !touched; ++column )
+				{
+					if( checkCollision( box, tiles.getBox( column, row ) ) )
+					{
+						int tileType = tiles.getType( column, row );
+						touched = ( tileType < 0 ) || ( ( tileType >= TILE_CENTER ) && ( tileType <= TILE_TOPLEFT ) );
+					}
+				}
+			}
+
+			if( touched )
+			{
+				++scanHits;
+			}
+		}
+		double scanTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_SCAN_QUERIES;
+
+		printf( "%d tiles: touchesWall %.3f us per query (%d/%d hits), full scan %.3f us per query (%d/%d hits)\n", side * side, queryTime, hits, BENCHMARK_QUERIES, scanTime, scanHits, BENCHMARK_SCAN_QUERIES );
+
+		tiles.render( camera );
+
+		start = SDL_GetPerformanceCounter();
+		for( int i = 0; i < BENCHMARK_FRAMES; ++i )
+		{
+			tiles.render( camera );
+		}
+		double renderTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_FRAMES;
+
+		int visibleTiles = 0;
+		start = SDL_GetPerformanceCounter();
+		for( int i = 0; i < BENCHMARK_SCAN_QUERIES; ++i )
+		{
+			for( int row = 0; row < tiles.getRows(); ++row )
+			{
+				for( int column = 0; column < tiles.getColumns(); ++column )
+				{
+					if( checkCollision( camera, tiles.getBox( column, row ) ) )
+					{
+						++visibleTiles;
+					}
+				}
+			}
+		}
+		double cullTime = ( SDL_GetPerformanceCounter() - start ) * 1000000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_SCAN_QUERIES;
+
+		printf( "%d tiles: render %.3f us per frame, per-tile culling %.3f us per frame (%d visible)\n", side * side, renderTime, cullTime, visibleTiles / BENCHMARK_SCAN_QUERIES );
+	}
+
+	remove( levelPath.c_str() );
+}
+
 int main( int argc, char* args[] )
 {
 	if( !init() )
@@ -633,12 +1681,23 @@ int main( int argc, char* args[] )
 	}
 	else
 	{
-		Tile* tileSet[ TOTAL_TILES ];
+		TileMap tileMap;
 
-		if( !loadMedia( tileSet ) )
+		if( ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--cook" ) )
+		{
+			if( !cookPack( "39_tiling/media.pak" ) )
+			{
+				printf( "Failed to cook media pack!\n" );
+			}
+		}
+		else if( !loadMedia( tileMap ) )
 		{
 			printf( "Failed to load media!\n" );
 		}
+		else if( ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--benchmark" ) )
+		{
+			benchmarkLevels();
+		}
 		else
 		{	
 			bool quit = false;
@@ -661,16 +1720,15 @@ int main( int argc, char* args[] )
 					dot.handleEvent( e );
 				}
 
-				dot.move( tileSet );
-				dot.setCamera( camera );
+				dot.move( tileMap );
+				dot.setCamera( camera, tileMap );
+
+				tileMap.streamChunks( camera );
 
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
-				for( int i = 0; i < TOTAL_TILES; ++i )
-				{
-					tileSet[ i ]->render( camera );
-				}
+				tileMap.render( camera );
 
 				dot.render( camera );
 
@@ -678,7 +1736,7 @@ int main( int argc, char* args[] )
 			}
 		}
 		
-		close( tileSet );
+		close( tileMap );
 	}
 
 	return 0;
@@ -3,9 +3,25 @@
 #include <stdio.h>
 #include <string>
 
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define PIXEL_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define PIXEL_SSE2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#define PIXEL_NEON
+#endif
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int TOTAL_BENCHMARK_SIZES = 2;
+const int BENCHMARK_WIDTHS[ TOTAL_BENCHMARK_SIZES ] = { 3840, 7680 };
+const int BENCHMARK_HEIGHTS[ TOTAL_BENCHMARK_SIZES ] = { 2160, 4320 };
+const int BENCHMARK_PASSES = 10;
+
 class LTexture
 {
 	public:
@@ -14,6 +30,8 @@ class LTexture
 		~LTexture();
 
 		bool loadFromFile( std::string path );
+
+		bool createBlank( int width, int height );
 		
 		#ifdef _SDL_TTF_H
 		bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
@@ -37,6 +55,8 @@ class LTexture
 		void* getPixels();
 		int getPitch();
 
+		bool replaceColor( Uint32 target, Uint32 replacement );
+
 	private:
 		SDL_Texture* mTexture;
 		void* mPixels;
@@ -52,6 +72,8 @@ bool loadMedia();
 
 void close();
 
+void benchmarkColorKey();
+
 SDL_Window* gWindow = NULL;
 
 SDL_Renderer* gRenderer = NULL;
@@ -85,34 +107,58 @@ bool LTexture::loadFromFile( std::string path )
 	}
 	else
 	{
-		SDL_Surface* formattedSurface = SDL_ConvertSurface( loadedSurface, SDL_GetWindowSurface( gWindow )->format, NULL );
-		if( formattedSurface == NULL )
+		SDL_Surface* sourceSurface = loadedSurface;
+		if( SDL_ISPIXELFORMAT_INDEXED( loadedSurface->format->format ) )
 		{
-			printf( "Unable to convert loaded surface to display format! SDL Error: %s\n", SDL_GetError() );
+			sourceSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_GetWindowPixelFormat( gWindow ), NULL );
+		}
+
+		if( sourceSurface == NULL )
+		{
+			printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
 		}
 		else
 		{
-			newTexture = SDL_CreateTexture( gRenderer, SDL_GetWindowPixelFormat( gWindow ), SDL_TEXTUREACCESS_STREAMING, formattedSurface->w, formattedSurface->h );
+			newTexture = SDL_CreateTexture( gRenderer, SDL_GetWindowPixelFormat( gWindow ), SDL_TEXTUREACCESS_STREAMING, sourceSurface->w, sourceSurface->h );
 			if( newTexture == NULL )
 			{
 				printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
 			}
 			else
 			{
-				SDL_LockTexture( newTexture, NULL, &mPixels, &mPitch );
+				if( SDL_LockTexture( newTexture, NULL, &mPixels, &mPitch ) != 0 )
+				{
+					printf( "Unable to lock texture! %s\n", SDL_GetError() );
+					SDL_DestroyTexture( newTexture );
+					newTexture = NULL;
+				}
+				else
+				{
+					if( SDL_ConvertPixels( sourceSurface->w, sourceSurface->h, sourceSurface->format->format, sourceSurface->pixels, sourceSurface->pitch, SDL_GetWindowPixelFormat( gWindow ), mPixels, mPitch ) != 0 )
+					{
+						printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
+						SDL_UnlockTexture( newTexture );
+						SDL_DestroyTexture( newTexture );
+						newTexture = NULL;
+					}
+					else
+					{
+						mWidth = sourceSurface->w;
+						mHeight = sourceSurface->h;
 
-				memcpy( mPixels, formattedSurface->pixels, formattedSurface->pitch * formattedSurface->h );
+						SDL_UnlockTexture( newTexture );
+					}
 
-				SDL_UnlockTexture( newTexture );
-				mPixels = NULL;
+					mPixels = NULL;
+				}
+			}
 
-				mWidth = formattedSurface->w;
-				mHeight = formattedSurface->h;
+			if( sourceSurface != loadedSurface )
+			{
+				SDL_FreeSurface( sourceSurface );
 			}
+		}
 
-			SDL_FreeSurface( formattedSurface );
-		}	
-		
 		SDL_FreeSurface( loadedSurface );
 	}
 
@@ -125,7 +171,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -151,6 +197,24 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 }
 #endif
 
+bool LTexture::createBlank( int width, int height )
+{
+	free();
+
+	mTexture = SDL_CreateTexture( gRenderer, SDL_GetWindowPixelFormat( gWindow ), SDL_TEXTUREACCESS_STREAMING, width, height );
+	if( mTexture == NULL )
+	{
+		printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		mWidth = width;
+		mHeight = height;
+	}
+
+	return mTexture != NULL;
+}
+
 void LTexture::free()
 {
 	if( mTexture != NULL )
@@ -252,6 +316,65 @@ int LTexture::getPitch()
 	return mPitch;
 }
 
+bool LTexture::replaceColor( Uint32 target, Uint32 replacement )
+{
+	if( mPixels == NULL )
+	{
+		printf( "Texture is not locked!\n" );
+		return false;
+	}
+
+#if defined( PIXEL_AVX2 )
+	__m256i wideTarget = _mm256_set1_epi32( (int)target );
+	__m256i wideReplacement = _mm256_set1_epi32( (int)replacement );
+#elif defined( PIXEL_SSE2 )
+	__m128i wideTarget = _mm_set1_epi32( (int)target );
+	__m128i wideReplacement = _mm_set1_epi32( (int)replacement );
+#elif defined( PIXEL_NEON )
+	uint32x4_t wideTarget = vdupq_n_u32( target );
+	uint32x4_t wideReplacement = vdupq_n_u32( replacement );
+#endif
+
+	for( int y = 0; y < mHeight; ++y )
+	{
+		Uint32* row = (Uint32*)( (Uint8*)mPixels + y * mPitch );
+		int x = 0;
+
+#if defined( PIXEL_AVX2 )
+		for( ; x + 8 <= mWidth; x += 8 )
+		{
+			__m256i pixels = _mm256_loadu_si256( (__m256i*)&row[ x ] );
+			__m256i mask = _mm256_cmpeq_epi32( pixels, wideTarget );
+			_mm256_storeu_si256( (__m256i*)&row[ x ], _mm256_blendv_epi8( pixels, wideReplacement, mask ) );
+		}
+#elif defined( PIXEL_SSE2 )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			__m128i pixels = _mm_loadu_si128( (__m128i*)&row[ x ] );
+			__m128i mask = _mm_cmpeq_epi32( pixels, wideTarget );
+			_mm_storeu_si128( (__m128i*)&row[ x ], _mm_or_si128( _mm_and_si128( mask, wideReplacement ), _mm_andnot_si128( mask, pixels ) ) );
+		}
+#elif defined( PIXEL_NEON )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			uint32x4_t pixels = vld1q_u32( &row[ x ] );
+			uint32x4_t mask = vceqq_u32( pixels, wideTarget );
+			vst1q_u32( &row[ x ], vbslq_u32( mask, wideReplacement, pixels ) );
+		}
+#endif
+
+		for( ; x < mWidth; ++x )
+		{
+			if( row[ x ] == target )
+			{
+				row[ x ] = replacement;
+			}
+		}
+	}
+
+	return true;
+}
+
 bool init()
 {
 	bool success = true;
@@ -316,19 +439,10 @@ bool loadMedia()
 		}
 		else
 		{
-			Uint32* pixels = (Uint32*)gFooTexture.getPixels();
-			int pixelCount = ( gFooTexture.getPitch() / 4 ) * gFooTexture.getHeight();
-
 			Uint32 colorKey = SDL_MapRGB( SDL_GetWindowSurface( gWindow )->format, 0, 0xFF, 0xFF );
 			Uint32 transparent = SDL_MapRGBA( SDL_GetWindowSurface( gWindow )->format, 0xFF, 0xFF, 0xFF, 0x00 );
 
-			for( int i = 0; i < pixelCount; ++i )
-			{
-				if( pixels[ i ] == colorKey )
-				{
-					pixels[ i ] = transparent;
-				}
-			}
+			gFooTexture.replaceColor( colorKey, transparent );
 
 			gFooTexture.unlockTexture();
 		}
@@ -350,6 +464,64 @@ void close()
 	SDL_Quit();
 }
 
+void benchmarkColorKey()
+{
+	Uint32 colorKey = SDL_MapRGB( SDL_GetWindowSurface( gWindow )->format, 0, 0xFF, 0xFF );
+	Uint32 transparent = SDL_MapRGBA( SDL_GetWindowSurface( gWindow )->format, 0xFF, 0xFF, 0xFF, 0x00 );
+	Uint32 opaque = SDL_MapRGB( SDL_GetWindowSurface( gWindow )->format, 0xFF, 0, 0 );
+
+	for( int size = 0; size < TOTAL_BENCHMARK_SIZES; ++size )
+	{
+		int width = BENCHMARK_WIDTHS[ size ];
+		int height = BENCHMARK_HEIGHTS[ size ];
+
+		LTexture texture;
+		if( !texture.createBlank( width, height ) || !texture.lockTexture() )
+		{
+			printf( "Unable to create %dx%d benchmark texture!\n", width, height );
+			continue;
+		}
+
+		Uint32* pixels = (Uint32*)texture.getPixels();
+		int pixelCount = ( texture.getPitch() / 4 ) * height;
+
+		Uint64 scalarTicks = 0;
+		Uint64 replaceTicks = 0;
+		for( int pass = 0; pass < BENCHMARK_PASSES; ++pass )
+		{
+			for( int i = 0; i < pixelCount; ++i )
+			{
+				pixels[ i ] = ( ( i / 16 + i / ( 16 * width ) ) % 2 == 0 ) ? colorKey : opaque;
+			}
+
+			Uint64 start = SDL_GetPerformanceCounter();
+			for( int i = 0; i < pixelCount; ++i )
+			{
+				if( pixels[ i ] == colorKey )
+				{
+					pixels[ i ] = transparent;
+				}
+			}
+			scalarTicks += SDL_GetPerformanceCounter() - start;
+
+			for( int i = 0; i < pixelCount; ++i )
+			{
+				pixels[ i ] = ( ( i / 16 + i / ( 16 * width ) ) % 2 == 0 ) ? colorKey : opaque;
+			}
+
+			start = SDL_GetPerformanceCounter();
+			texture.replaceColor( colorKey, transparent );
+			replaceTicks += SDL_GetPerformanceCounter() - start;
+		}
+
+		double scalarTime = scalarTicks * 1000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_PASSES;
+		double replaceTime = replaceTicks * 1000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_PASSES;
+		printf( "%dx%d: scalar loop %.3f ms per pass, replaceColor %.3f ms per pass\n", width, height, scalarTime, replaceTime );
+
+		texture.unlockTexture();
+	}
+}
+
 int main( int argc, char* args[] )
 {
 	if( !init() )
@@ -362,6 +534,10 @@ int main( int argc, char* args[] )
 		{
 			printf( "Failed to load media!\n" );
 		}
+		else if( ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--benchmark" ) )
+		{
+			benchmarkColorKey();
+		}
 		else
 		{	
 			bool quit = false;
@@ -2,10 +2,32 @@
 #include <SDL_image.h>
 #include <stdio.h>
 #include <string>
+#include <vector>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define PIXEL_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define PIXEL_SSE2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#define PIXEL_NEON
+#endif
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int MAX_BATCH_GLYPHS = 1024;
+const int MAX_CACHED_LAYOUTS = 16;
+
+const int GLYPH_PAGE_SIZE = 256;
+const int TOTAL_GLYPH_PAGES = 0x110000 / GLYPH_PAGE_SIZE;
+const Uint32 REPLACEMENT_GLYPH = '?';
+
+const int BENCHMARK_SHEET_SIZE = 4096;
+const int BENCHMARK_PASSES = 10;
+
 class LTexture
 {
 	public:
@@ -14,6 +36,8 @@ class LTexture
 		~LTexture();
 
 		bool loadFromFile( std::string path );
+
+		bool createBlank( int width, int height );
 		
 		#ifdef _SDL_TTF_H
 		bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
@@ -29,6 +53,8 @@ class LTexture
 		
 		void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
 
+		void renderGeometry( SDL_Vertex* vertices, int vertexCount, int* indices, int indexCount );
+
 		int getWidth();
 		int getHeight();
 
@@ -38,6 +64,8 @@ class LTexture
 		int getPitch();
 		Uint32 getPixel32( unsigned int x, unsigned int y );
 
+		bool replaceColor( Uint32 target, Uint32 replacement );
+
 	private:
 		SDL_Texture* mTexture;
 		void* mPixels;
@@ -47,21 +75,68 @@ class LTexture
 		int mHeight;
 };
 
+struct LGlyphPage
+{
+	LTexture* bitmap;
+	bool owned;
+
+	SDL_Rect chars[ GLYPH_PAGE_SIZE ];
+	int advances[ GLYPH_PAGE_SIZE ];
+};
+
+struct LTextLayout
+{
+	std::string text;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<LTexture*> bitmaps;
+	Uint32 lastUsed;
+};
+
 class LBitmapFont
 {
     public:
 		LBitmapFont();
 
+		~LBitmapFont();
+
 		bool buildFont( LTexture *bitmap );
 
+		void setPagePath( std::string pagePath );
+
+		void free();
+
 		void renderText( int x, int y, std::string text );
 
+		void queueText( int x, int y, std::string text );
+		void flush();
+
+		int getTextWidth( std::string text );
+
     private:
+		bool buildPage( LGlyphPage* page, LTexture* bitmap, bool firstPage );
+
+		bool findInkSpan( Uint32* pixels, int count, Uint32 bgColor, int& first, int& last );
+
+		LGlyphPage* getPage( Uint32 codepoint );
+
+		LGlyphPage* getGlyph( Uint32 codepoint, int& index );
+
+		LTextLayout* getLayout( std::string& text );
+
 		LTexture* mBitmap;
 
-		SDL_Rect mChars[ 256 ];
+		LGlyphPage* mPages[ TOTAL_GLYPH_PAGES ];
+		std::string mPagePath;
+
+		int mNewLine, mSpace, mTop;
 
-		int mNewLine, mSpace;
+		LTextLayout mLayouts[ MAX_CACHED_LAYOUTS ];
+		Uint32 mLayoutClock;
+
+		SDL_Vertex mVertices[ MAX_BATCH_GLYPHS * 4 ];
+		int mIndices[ MAX_BATCH_GLYPHS * 6 ];
+		int mGlyphCount;
+		LTexture* mBatchBitmap;
 };
 
 bool init();
@@ -70,6 +145,12 @@ bool loadMedia();
 
 void close();
 
+Uint32 decodeUTF8( std::string& text, int& position );
+
+int scanFontColumns( LTexture* bitmap );
+
+void benchmarkFontScan( LTexture* source );
+
 SDL_Window* gWindow = NULL;
 
 SDL_Renderer* gRenderer = NULL;
@@ -104,14 +185,19 @@ bool LTexture::loadFromFile( std::string path )
 	}
 	else
 	{
-		SDL_Surface* formattedSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
-		if( formattedSurface == NULL )
+		SDL_Surface* sourceSurface = loadedSurface;
+		if( SDL_ISPIXELFORMAT_INDEXED( loadedSurface->format->format ) )
+		{
+			sourceSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
+		}
+
+		if( sourceSurface == NULL )
 		{
 			printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
 		}
 		else
 		{
-			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, formattedSurface->w, formattedSurface->h );
+			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, sourceSurface->w, sourceSurface->h );
 			if( newTexture == NULL )
 			{
 				printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
@@ -120,34 +206,46 @@ bool LTexture::loadFromFile( std::string path )
 			{
 				SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
 
-				SDL_LockTexture( newTexture, &formattedSurface->clip_rect, &mPixels, &mPitch );
-
-				memcpy( mPixels, formattedSurface->pixels, formattedSurface->pitch * formattedSurface->h );
-
-				mWidth = formattedSurface->w;
-				mHeight = formattedSurface->h;
+				if( SDL_LockTexture( newTexture, NULL, &mPixels, &mPitch ) != 0 )
+				{
+					printf( "Unable to lock texture! %s\n", SDL_GetError() );
+					SDL_DestroyTexture( newTexture );
+					newTexture = NULL;
+				}
+				else
+				{
+					if( SDL_ConvertPixels( sourceSurface->w, sourceSurface->h, sourceSurface->format->format, sourceSurface->pixels, sourceSurface->pitch, SDL_PIXELFORMAT_RGBA8888, mPixels, mPitch ) != 0 )
+					{
+						printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
+						SDL_UnlockTexture( newTexture );
+						SDL_DestroyTexture( newTexture );
+						newTexture = NULL;
+					}
+					else
+					{
+						mWidth = sourceSurface->w;
+						mHeight = sourceSurface->h;
 
-				Uint32* pixels = (Uint32*)mPixels;
-				int pixelCount = ( mPitch / 4 ) * mHeight;
+						SDL_PixelFormat* mappingFormat = SDL_AllocFormat( SDL_PIXELFORMAT_RGBA8888 );
+						Uint32 colorKey = SDL_MapRGB( mappingFormat, 0, 0xFF, 0xFF );
+						Uint32 transparent = SDL_MapRGBA( mappingFormat, 0x00, 0xFF, 0xFF, 0x00 );
+						SDL_FreeFormat( mappingFormat );
 
-				Uint32 colorKey = SDL_MapRGB( formattedSurface->format, 0, 0xFF, 0xFF );
-				Uint32 transparent = SDL_MapRGBA( formattedSurface->format, 0x00, 0xFF, 0xFF, 0x00 );
+						replaceColor( colorKey, transparent );
 
-				for( int i = 0; i < pixelCount; ++i )
-				{
-					if( pixels[ i ] == colorKey )
-					{
-						pixels[ i ] = transparent;
+						SDL_UnlockTexture( newTexture );
 					}
+
+					mPixels = NULL;
 				}
+			}
 
-				SDL_UnlockTexture( newTexture );
-				mPixels = NULL;
+			if( sourceSurface != loadedSurface )
+			{
+				SDL_FreeSurface( sourceSurface );
 			}
+		}
 
-			SDL_FreeSurface( formattedSurface );
-		}	
-		
 		SDL_FreeSurface( loadedSurface );
 	}
 
@@ -160,7 +258,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -186,6 +284,24 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 }
 #endif
 
+bool LTexture::createBlank( int width, int height )
+{
+	free();
+
+	mTexture = SDL_CreateTexture( gRenderer, SDL_GetWindowPixelFormat( gWindow ), SDL_TEXTUREACCESS_STREAMING, width, height );
+	if( mTexture == NULL )
+	{
+		printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
+	}
+	else
+	{
+		mWidth = width;
+		mHeight = height;
+	}
+
+	return mTexture != NULL;
+}
+
 void LTexture::free()
 {
 	if( mTexture != NULL )
@@ -227,6 +343,11 @@ void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* ce
 	SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
 }
 
+void LTexture::renderGeometry( SDL_Vertex* vertices, int vertexCount, int* indices, int indexCount )
+{
+	SDL_RenderGeometry( gRenderer, mTexture, vertices, vertexCount, indices, indexCount );
+}
+
 int LTexture::getWidth()
 {
 	return mWidth;
@@ -294,14 +415,155 @@ Uint32 LTexture::getPixel32( unsigned int x, unsigned int y )
     return pixels[ ( y * ( mPitch / 4 ) ) + x ];
 }
 
+bool LTexture::replaceColor( Uint32 target, Uint32 replacement )
+{
+	if( mPixels == NULL )
+	{
+		printf( "Texture is not locked!\n" );
+		return false;
+	}
+
+#if defined( PIXEL_AVX2 )
+	__m256i wideTarget = _mm256_set1_epi32( (int)target );
+	__m256i wideReplacement = _mm256_set1_epi32( (int)replacement );
+#elif defined( PIXEL_SSE2 )
+	__m128i wideTarget = _mm_set1_epi32( (int)target );
+	__m128i wideReplacement = _mm_set1_epi32( (int)replacement );
+#elif defined( PIXEL_NEON )
+	uint32x4_t wideTarget = vdupq_n_u32( target );
+	uint32x4_t wideReplacement = vdupq_n_u32( replacement );
+#endif
+
+	for( int y = 0; y < mHeight; ++y )
+	{
+		Uint32* row = (Uint32*)( (Uint8*)mPixels + y * mPitch );
+		int x = 0;
+
+#if defined( PIXEL_AVX2 )
+		for( ; x + 8 <= mWidth; x += 8 )
+		{
+			__m256i pixels = _mm256_loadu_si256( (__m256i*)&row[ x ] );
+			__m256i mask = _mm256_cmpeq_epi32( pixels, wideTarget );
+			_mm256_storeu_si256( (__m256i*)&row[ x ], _mm256_blendv_epi8( pixels, wideReplacement, mask ) );
+		}
+#elif defined( PIXEL_SSE2 )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			__m128i pixels = _mm_loadu_si128( (__m128i*)&row[ x ] );
+			__m128i mask = _mm_cmpeq_epi32( pixels, wideTarget );
+			_mm_storeu_si128( (__m128i*)&row[ x ], _mm_or_si128( _mm_and_si128( mask, wideReplacement ), _mm_andnot_si128( mask, pixels ) ) );
+		}
+#elif defined( PIXEL_NEON )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			uint32x4_t pixels = vld1q_u32( &row[ x ] );
+			uint32x4_t mask = vceqq_u32( pixels, wideTarget );
+			vst1q_u32( &row[ x ], vbslq_u32( mask, wideReplacement, pixels ) );
+		}
+#endif
+
+		for( ; x < mWidth; ++x )
+		{
+			if( row[ x ] == target )
+			{
+				row[ x ] = replacement;
+			}
+		}
+	}
+
+	return true;
+}
+
 LBitmapFont::LBitmapFont()
 {
     mBitmap = NULL;
     mNewLine = 0;
     mSpace = 0;
+    mTop = 0;
+
+	for( int i = 0; i < TOTAL_GLYPH_PAGES; ++i )
+	{
+		mPages[ i ] = NULL;
+	}
+
+	for( int i = 0; i < MAX_CACHED_LAYOUTS; ++i )
+	{
+		mLayouts[ i ].lastUsed = 0;
+	}
+	mLayoutClock = 0;
+
+	for( int i = 0; i < MAX_BATCH_GLYPHS; ++i )
+	{
+		mIndices[ i * 6 ] = i * 4;
+		mIndices[ i * 6 + 1 ] = i * 4 + 1;
+		mIndices[ i * 6 + 2 ] = i * 4 + 2;
+		mIndices[ i * 6 + 3 ] = i * 4;
+		mIndices[ i * 6 + 4 ] = i * 4 + 2;
+		mIndices[ i * 6 + 5 ] = i * 4 + 3;
+	}
+	mGlyphCount = 0;
+	mBatchBitmap = NULL;
+}
+
+LBitmapFont::~LBitmapFont()
+{
+	free();
 }
 
 bool LBitmapFont::buildFont( LTexture* bitmap )
+{
+	free();
+
+	LGlyphPage* page = new LGlyphPage;
+	page->bitmap = bitmap;
+	page->owned = false;
+
+	if( !buildPage( page, bitmap, true ) )
+	{
+		delete page;
+		return false;
+	}
+
+	mPages[ 0 ] = page;
+	mBitmap = bitmap;
+
+	return true;
+}
+
+void LBitmapFont::setPagePath( std::string pagePath )
+{
+	mPagePath = pagePath;
+}
+
+void LBitmapFont::free()
+{
+	for( int i = 0; i < TOTAL_GLYPH_PAGES; ++i )
+	{
+		if( mPages[ i ] != NULL )
+		{
+			if( mPages[ i ]->owned )
+			{
+				delete mPages[ i ]->bitmap;
+			}
+			delete mPages[ i ];
+			mPages[ i ] = NULL;
+		}
+	}
+
+	for( int i = 0; i < MAX_CACHED_LAYOUTS; ++i )
+	{
+		mLayouts[ i ].text.clear();
+		mLayouts[ i ].vertices.clear();
+		mLayouts[ i ].bitmaps.clear();
+		mLayouts[ i ].lastUsed = 0;
+	}
+
+	mBitmap = NULL;
+	mGlyphCount = 0;
+	mBatchBitmap = NULL;
+}
+
+bool LBitmapFont::buildPage( LGlyphPage* page, LTexture* bitmap, bool firstPage )
 {
 	bool success = true;
 	
@@ -317,144 +579,403 @@ bool LBitmapFont::buildFont( LTexture* bitmap )
 		int cellW = bitmap->getWidth() / 16;
 		int cellH = bitmap->getHeight() / 16;
 
-		int top = cellH;
-		int baseA = cellH;
+		int inkLeft[ 256 ];
+		int inkRight[ 256 ];
+		int inkTop[ 256 ];
+		int inkBottom[ 256 ];
+		for( int i = 0; i < 256; ++i )
+		{
+			inkLeft[ i ] = cellW;
+			inkRight[ i ] = -1;
+			inkTop[ i ] = cellH;
+			inkBottom[ i ] = -1;
+		}
 
-		int currentChar = 0;
+		Uint8* pixels = (Uint8*)bitmap->getPixels();
+		int pitch = bitmap->getPitch();
 
-		for( int rows = 0; rows < 16; ++rows )
+		for( int pY = 0; pY < cellH * 16; ++pY )
 		{
+			Uint32* row = (Uint32*)( pixels + pY * pitch );
+			int rows = pY / cellH;
+			int pRow = pY % cellH;
+
 			for( int cols = 0; cols < 16; ++cols )
 			{
-				mChars[ currentChar ].x = cellW * cols;
-				mChars[ currentChar ].y = cellH * rows;
-
-				mChars[ currentChar ].w = cellW;
-				mChars[ currentChar ].h = cellH;
-
-				for( int pCol = 0; pCol < cellW; ++pCol )
+				int first = 0;
+				int last = 0;
+				if( findInkSpan( &row[ cellW * cols ], cellW, bgColor, first, last ) )
 				{
-					for( int pRow = 0; pRow < cellH; ++pRow )
+					int currentChar = rows * 16 + cols;
+					if( first < inkLeft[ currentChar ] )
 					{
-						int pX = ( cellW * cols ) + pCol;
-						int pY = ( cellH * rows ) + pRow;
-
-						if( bitmap->getPixel32( pX, pY ) != bgColor )
-						{
-							mChars[ currentChar ].x = pX;
-
-							pCol = cellW;
-							pRow = cellH;
-						}
+						inkLeft[ currentChar ] = first;
 					}
-				}
-
-				for( int pColW = cellW - 1; pColW >= 0; --pColW )
-				{
-					for( int pRowW = 0; pRowW < cellH; ++pRowW )
+					if( last > inkRight[ currentChar ] )
 					{
-						int pX = ( cellW * cols ) + pColW;
-						int pY = ( cellH * rows ) + pRowW;
-
-						if( bitmap->getPixel32( pX, pY ) != bgColor )
-						{
-							mChars[ currentChar ].w = ( pX - mChars[ currentChar ].x ) + 1;
-
-							pColW = -1;
-							pRowW = cellH;
-						}
+						inkRight[ currentChar ] = last;
 					}
-				}
-
-				for( int pRow = 0; pRow < cellH; ++pRow )
-				{
-					for( int pCol = 0; pCol < cellW; ++pCol )
+					if( pRow < inkTop[ currentChar ] )
 					{
-						int pX = ( cellW * cols ) + pCol;
-						int pY = ( cellH * rows ) + pRow;
-
-						if( bitmap->getPixel32( pX, pY ) != bgColor )
-						{
-							if( pRow < top )
-							{
-								top = pRow;
-							}
-
-							pCol = cellW;
-							pRow = cellH;
-						}
+						inkTop[ currentChar ] = pRow;
 					}
+					inkBottom[ currentChar ] = pRow;
 				}
+			}
+		}
 
-				if( currentChar == 'A' )
-				{
-					for( int pRow = cellH - 1; pRow >= 0; --pRow )
-					{
-						for( int pCol = 0; pCol < cellW; ++pCol )
-						{
-							int pX = ( cellW * cols ) + pCol;
-							int pY = ( cellH * rows ) + pRow;
+		int top = cellH;
+		int baseA = cellH;
 
-							if( bitmap->getPixel32( pX, pY ) != bgColor )
-							{
-								baseA = pRow;
+		for( int currentChar = 0; currentChar < 256; ++currentChar )
+		{
+			int rows = currentChar / 16;
+			int cols = currentChar % 16;
 
-								pCol = cellW;
-								pRow = -1;
-							}
-						}
-					}
-				}
+			page->chars[ currentChar ].x = cellW * cols;
+			page->chars[ currentChar ].y = cellH * rows;
+			page->chars[ currentChar ].w = cellW;
+			page->chars[ currentChar ].h = cellH;
+
+			if( inkRight[ currentChar ] >= 0 )
+			{
+				page->chars[ currentChar ].x += inkLeft[ currentChar ];
+				page->chars[ currentChar ].w = ( inkRight[ currentChar ] - inkLeft[ currentChar ] ) + 1;
 
-				++currentChar;
+				if( inkTop[ currentChar ] < top )
+				{
+					top = inkTop[ currentChar ];
+				}
 			}
 		}
 
-		mSpace = cellW / 2;
+		if( firstPage )
+		{
+			if( inkBottom[ 'A' ] >= 0 )
+			{
+				baseA = inkBottom[ 'A' ];
+			}
 
-		mNewLine = baseA - top;
+			mSpace = cellW / 2;
 
-		for( int i = 0; i < 256; ++i )
+			mNewLine = baseA - top;
+
+			mTop = top;
+		}
+
+		for( int i = 0; i < GLYPH_PAGE_SIZE; ++i )
 		{
-			mChars[ i ].y += top;
-			mChars[ i ].h -= top;
+			page->chars[ i ].y += mTop;
+			page->chars[ i ].h -= mTop;
+			page->advances[ i ] = page->chars[ i ].w + 1;
 		}
 
 		bitmap->unlockTexture();
-		mBitmap = bitmap;
 	}
 
 	return success;
 }
 
+bool LBitmapFont::findInkSpan( Uint32* pixels, int count, Uint32 bgColor, int& first, int& last )
+{
+	int x = 0;
+
+#if defined( PIXEL_AVX2 )
+	__m256i wideBg = _mm256_set1_epi32( (int)bgColor );
+	for( ; x + 8 <= count; x += 8 )
+	{
+		__m256i mask = _mm256_cmpeq_epi32( _mm256_loadu_si256( (__m256i*)&pixels[ x ] ), wideBg );
+		if( _mm256_movemask_ps( _mm256_castsi256_ps( mask ) ) != 0xFF )
+		{
+			break;
+		}
+	}
+#elif defined( PIXEL_SSE2 )
+	__m128i wideBg = _mm_set1_epi32( (int)bgColor );
+	for( ; x + 4 <= count; x += 4 )
+	{
+		__m128i mask = _mm_cmpeq_epi32( _mm_loadu_si128( (__m128i*)&pixels[ x ] ), wideBg );
+		if( _mm_movemask_ps( _mm_castsi128_ps( mask ) ) != 0xF )
+		{
+			break;
+		}
+	}
+#elif defined( PIXEL_NEON )
+	uint32x4_t wideBg = vdupq_n_u32( bgColor );
+	for( ; x + 4 <= count; x += 4 )
+	{
+		uint16x4_t mask = vmovn_u32( vceqq_u32( vld1q_u32( &pixels[ x ] ), wideBg ) );
+		if( vget_lane_u64( vreinterpret_u64_u16( mask ), 0 ) != 0xFFFFFFFFFFFFFFFFull )
+		{
+			break;
+		}
+	}
+#endif
+
+	while( x < count && pixels[ x ] == bgColor )
+	{
+		++x;
+	}
+
+	if( x == count )
+	{
+		return false;
+	}
+
+	first = x;
+	x = count;
+
+#if defined( PIXEL_AVX2 )
+	for( ; x - 8 >= first; x -= 8 )
+	{
+		__m256i mask = _mm256_cmpeq_epi32( _mm256_loadu_si256( (__m256i*)&pixels[ x - 8 ] ), wideBg );
+		if( _mm256_movemask_ps( _mm256_castsi256_ps( mask ) ) != 0xFF )
+		{
+			break;
+		}
+	}
+#elif defined( PIXEL_SSE2 )
+	for( ; x - 4 >= first; x -= 4 )
+	{
+		__m128i mask = _mm_cmpeq_epi32( _mm_loadu_si128( (__m128i*)&pixels[ x - 4 ] ), wideBg );
+		if( _mm_movemask_ps( _mm_castsi128_ps( mask ) ) != 0xF )
+		{
+			break;
+		}
+	}
+#elif defined( PIXEL_NEON )
+	for( ; x - 4 >= first; x -= 4 )
+	{
+		uint16x4_t mask = vmovn_u32( vceqq_u32( vld1q_u32( &pixels[ x - 4 ] ), wideBg ) );
+		if( vget_lane_u64( vreinterpret_u64_u16( mask ), 0 ) != 0xFFFFFFFFFFFFFFFFull )
+		{
+			break;
+		}
+	}
+#endif
+
+	while( pixels[ x - 1 ] == bgColor )
+	{
+		--x;
+	}
+
+	last = x - 1;
+	return true;
+}
+
 void LBitmapFont::renderText( int x, int y, std::string text )
 {
-    if( mBitmap != NULL )
-    {
-		int curX = x, curY = y;
+	queueText( x, y, text );
+	flush();
+}
+
+void LBitmapFont::queueText( int x, int y, std::string text )
+{
+	if( mBitmap == NULL )
+	{
+		return;
+	}
+
+	LTextLayout* layout = getLayout( text );
+
+	int glyphCount = layout->bitmaps.size();
+	for( int i = 0; i < glyphCount; ++i )
+	{
+		if( layout->bitmaps[ i ] != mBatchBitmap )
+		{
+			flush();
+			mBatchBitmap = layout->bitmaps[ i ];
+		}
+
+		if( mGlyphCount == MAX_BATCH_GLYPHS )
+		{
+			flush();
+		}
+
+		SDL_Vertex* source = &layout->vertices[ i * 4 ];
+		SDL_Vertex* destination = &mVertices[ mGlyphCount * 4 ];
+		for( int j = 0; j < 4; ++j )
+		{
+			destination[ j ] = source[ j ];
+			destination[ j ].position.x += x;
+			destination[ j ].position.y += y;
+		}
+		++mGlyphCount;
+	}
+}
+
+void LBitmapFont::flush()
+{
+	if( mGlyphCount > 0 )
+	{
+		mBatchBitmap->renderGeometry( mVertices, mGlyphCount * 4, mIndices, mGlyphCount * 6 );
+		mGlyphCount = 0;
+	}
+}
+
+int LBitmapFont::getTextWidth( std::string text )
+{
+	int width = 0;
+	int curX = 0;
+
+	int position = 0;
+	while( position < (int)text.length() )
+	{
+		Uint32 codepoint = decodeUTF8( text, position );
+		if( codepoint == '\n' )
+		{
+			curX = 0;
+			continue;
+		}
+
+		if( codepoint == ' ' )
+		{
+			curX += mSpace;
+		}
+		else
+		{
+			int index = 0;
+			LGlyphPage* page = getGlyph( codepoint, index );
+			if( page != NULL )
+			{
+				curX += page->advances[ index ];
+			}
+		}
+
+		if( curX > width )
+		{
+			width = curX;
+		}
+	}
+
+	return width;
+}
+
+LGlyphPage* LBitmapFont::getPage( Uint32 codepoint )
+{
+	int pageIndex = codepoint / GLYPH_PAGE_SIZE;
+	if( pageIndex >= TOTAL_GLYPH_PAGES )
+	{
+		return NULL;
+	}
+
+	if( mPages[ pageIndex ] == NULL && mBitmap != NULL && !mPagePath.empty() )
+	{
+		LGlyphPage* page = new LGlyphPage;
+		page->bitmap = NULL;
+		page->owned = true;
+
+		char path[ 256 ];
+		SDL_snprintf( path, sizeof( path ), mPagePath.c_str(), pageIndex );
+
+		LTexture* bitmap = new LTexture;
+		if( bitmap->loadFromFile( path ) && buildPage( page, bitmap, false ) )
+		{
+			page->bitmap = bitmap;
+		}
+		else
+		{
+			printf( "Glyph page %04X is unavailable!\n", pageIndex );
+			delete bitmap;
+		}
+
+		mPages[ pageIndex ] = page;
+	}
+
+	if( mPages[ pageIndex ] == NULL || mPages[ pageIndex ]->bitmap == NULL )
+	{
+		return NULL;
+	}
+
+	return mPages[ pageIndex ];
+}
+
+LGlyphPage* LBitmapFont::getGlyph( Uint32 codepoint, int& index )
+{
+	LGlyphPage* page = getPage( codepoint );
+	if( page == NULL )
+	{
+		page = getPage( REPLACEMENT_GLYPH );
+		codepoint = REPLACEMENT_GLYPH;
+	}
+
+	index = codepoint % GLYPH_PAGE_SIZE;
+	return page;
+}
+
+LTextLayout* LBitmapFont::getLayout( std::string& text )
+{
+	++mLayoutClock;
+
+	LTextLayout* layout = &mLayouts[ 0 ];
+	for( int i = 0; i < MAX_CACHED_LAYOUTS; ++i )
+	{
+		if( mLayouts[ i ].lastUsed != 0 && mLayouts[ i ].text == text )
+		{
+			mLayouts[ i ].lastUsed = mLayoutClock;
+			return &mLayouts[ i ];
+		}
+
+		if( mLayouts[ i ].lastUsed < layout->lastUsed )
+		{
+			layout = &mLayouts[ i ];
+		}
+	}
+
+	layout->text = text;
+	layout->vertices.clear();
+	layout->bitmaps.clear();
+	layout->lastUsed = mLayoutClock;
+
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+	int curX = 0, curY = 0;
+	int position = 0;
+	while( position < (int)text.length() )
+	{
+		Uint32 codepoint = decodeUTF8( text, position );
+		if( codepoint == ' ' )
+		{
+			curX += mSpace;
+		}
+		else if( codepoint == '\n' )
+		{
+			curY += mNewLine;
+			curX = 0;
+		}
+		else
+		{
+			int index = 0;
+			LGlyphPage* page = getGlyph( codepoint, index );
+			if( page == NULL )
+			{
+				continue;
+			}
 
-        for( int i = 0; i < text.length(); ++i )
-        {
-            if( text[ i ] == ' ' )
-            {
-                curX += mSpace;
-            }
-            else if( text[ i ] == '\n' )
-            {
-                curY += mNewLine;
+			SDL_Rect& clip = page->chars[ index ];
+			float bitmapW = (float)page->bitmap->getWidth();
+			float bitmapH = (float)page->bitmap->getHeight();
 
-                curX = x;
-            }
-            else
-            {
-                int ascii = (unsigned char)text[ i ];
+			float u0 = clip.x / bitmapW;
+			float v0 = clip.y / bitmapH;
+			float u1 = ( clip.x + clip.w ) / bitmapW;
+			float v1 = ( clip.y + clip.h ) / bitmapH;
 
-				mBitmap->render( curX, curY, &mChars[ ascii ] );
+			SDL_Vertex quad[ 4 ] =
+			{
+				{ { (float)curX, (float)curY }, white, { u0, v0 } },
+				{ { (float)( curX + clip.w ), (float)curY }, white, { u1, v0 } },
+				{ { (float)( curX + clip.w ), (float)( curY + clip.h ) }, white, { u1, v1 } },
+				{ { (float)curX, (float)( curY + clip.h ) }, white, { u0, v1 } }
+			};
+			layout->vertices.insert( layout->vertices.end(), quad, quad + 4 );
+			layout->bitmaps.push_back( page->bitmap );
+
+			curX += page->advances[ index ];
+		}
+	}
 
-                curX += mChars[ ascii ].w + 1;
-            }
-        }
-    }
+	return layout;
 }
 
 bool init()
@@ -518,6 +1039,7 @@ bool loadMedia()
 	else
 	{
 		gBitmapFont.buildFont( &gBitmapTexture );
+		gBitmapFont.setPagePath( "41_bitmap_fonts/lazyfont_%04X.png" );
 	}
 
 	return success;
@@ -525,6 +1047,7 @@ bool loadMedia()
 
 void close()
 {
+	gBitmapFont.free();
 	gBitmapTexture.free();
 
 	SDL_DestroyRenderer( gRenderer );
@@ -536,6 +1059,186 @@ void close()
 	SDL_Quit();
 }
 
+Uint32 decodeUTF8( std::string& text, int& position )
+{
+	Uint8 lead = text[ position ];
+
+	int length = 0;
+	Uint32 codepoint = 0;
+	if( lead < 0x80 )
+	{
+		++position;
+		return lead;
+	}
+	else if( lead >= 0xC2 && lead < 0xE0 )
+	{
+		length = 2;
+		codepoint = lead & 0x1F;
+	}
+	else if( lead >= 0xE0 && lead < 0xF0 )
+	{
+		length = 3;
+		codepoint = lead & 0x0F;
+	}
+	else if( lead >= 0xF0 && lead < 0xF5 )
+	{
+		length = 4;
+		codepoint = lead & 0x07;
+	}
+	else
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	if( position + length > (int)text.length() )
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	for( int i = 1; i < length; ++i )
+	{
+		Uint8 next = text[ position + i ];
+		if( ( next & 0xC0 ) != 0x80 )
+		{
+			++position;
+			return 0xFFFD;
+		}
+
+		codepoint = ( codepoint << 6 ) | ( next & 0x3F );
+	}
+
+	if( ( length == 3 && codepoint < 0x800 ) || ( length == 4 && codepoint < 0x10000 ) || ( codepoint >= 0xD800 && codepoint <= 0xDFFF ) || codepoint > 0x10FFFF )
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	position += length;
+	return codepoint;
+}
+
+int scanFontColumns( LTexture* bitmap )
+{
+	Uint32 bgColor = bitmap->getPixel32( 0, 0 );
+
+	int cellW = bitmap->getWidth() / 16;
+	int cellH = bitmap->getHeight() / 16;
+
+	int top = cellH;
+	int inkWidth = 0;
+
+	for( int rows = 0; rows < 16; ++rows )
+	{
+		for( int cols = 0; cols < 16; ++cols )
+		{
+			int left = cellW * cols;
+			int width = cellW;
+
+			for( int pCol = 0; pCol < cellW; ++pCol )
+			{
+				for( int pRow = 0; pRow < cellH; ++pRow )
+				{
+					int pX = ( cellW * cols ) + pCol;
+					int pY = ( cellH * rows ) + pRow;
+					if( bitmap->getPixel32( pX, pY ) != bgColor )
+					{
+						left = pX;
+						pCol = cellW;
+						pRow = cellH;
+					}
+				}
+			}
+
+			for( int pColW = cellW - 1; pColW >= 0; --pColW )
+			{
+				for( int pRowW = 0; pRowW < cellH; ++pRowW )
+				{
+					int pX = ( cellW * cols ) + pColW;
+					int pY = ( cellH * rows ) + pRowW;
+					if( bitmap->getPixel32( pX, pY ) != bgColor )
+					{
+						width = ( pX - left ) + 1;
+						pColW = -1;
+						pRowW = cellH;
+					}
+				}
+			}
+
+			for( int pRow = 0; pRow < cellH; ++pRow )
+			{
+				for( int pCol = 0; pCol < cellW; ++pCol )
+				{
+					int pX = ( cellW * cols ) + pCol;
+					int pY = ( cellH * rows ) + pRow;
+					if( bitmap->getPixel32( pX, pY ) != bgColor )
+					{
+						if( pRow < top )
+						{
+							top = pRow;
+						}
+						pCol = cellW;
+						pRow = cellH;
+					}
+				}
+			}
+
+			inkWidth += width;
+		}
+	}
+
+	return inkWidth + top;
+}
+
+void benchmarkFontScan( LTexture* source )
+{
+	LTexture sheet;
+	if( !sheet.createBlank( BENCHMARK_SHEET_SIZE, BENCHMARK_SHEET_SIZE ) || !sheet.lockTexture() )
+	{
+		printf( "Unable to create %dx%d benchmark font sheet!\n", BENCHMARK_SHEET_SIZE, BENCHMARK_SHEET_SIZE );
+		return;
+	}
+
+	if( !source->lockTexture() )
+	{
+		printf( "Unable to lock bitmap font texture!\n" );
+		sheet.unlockTexture();
+		return;
+	}
+
+	for( int y = 0; y < BENCHMARK_SHEET_SIZE; ++y )
+	{
+		Uint32* row = (Uint32*)( (Uint8*)sheet.getPixels() + y * sheet.getPitch() );
+		for( int x = 0; x < BENCHMARK_SHEET_SIZE; ++x )
+		{
+			row[ x ] = source->getPixel32( x * source->getWidth() / BENCHMARK_SHEET_SIZE, y * source->getHeight() / BENCHMARK_SHEET_SIZE );
+		}
+	}
+
+	source->unlockTexture();
+
+	int checksum = 0;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for( int pass = 0; pass < BENCHMARK_PASSES; ++pass )
+	{
+		checksum += scanFontColumns( &sheet );
+	}
+	double columnTime = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_PASSES;
+
+	sheet.unlockTexture();
+
+	LBitmapFont font;
+	start = SDL_GetPerformanceCounter();
+	for( int pass = 0; pass < BENCHMARK_PASSES; ++pass )
+	{
+		font.buildFont( &sheet );
+	}
+	double buildTime = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency() / BENCHMARK_PASSES;
+
+	printf( "%dx%d font sheet: getPixel32 column scan %.3f ms (checksum %d), buildFont %.3f ms\n", BENCHMARK_SHEET_SIZE, BENCHMARK_SHEET_SIZE, columnTime, checksum, buildTime );
+}
+
 int main( int argc, char* args[] )
 {
 	if( !init() )
@@ -548,6 +1251,10 @@ int main( int argc, char* args[] )
 		{
 			printf( "Failed to load media!\n" );
 		}
+		else if( ( argc > 1 ) && ( std::string( args[ 1 ] ) == "--benchmark" ) )
+		{
+			benchmarkFontScan( &gBitmapTexture );
+		}
 		else
 		{	
 			bool quit = false;
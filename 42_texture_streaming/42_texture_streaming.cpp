@@ -1,11 +1,40 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <SDL_thread.h>
 #include <stdio.h>
 #include <string>
 
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define PIXEL_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define PIXEL_SSE2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#define PIXEL_NEON
+#endif
+
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int MAX_DIRTY_RECTS = 32;
+
+const int STREAM_PITCH_ALIGN = 64;
+const int STREAM_DIRTY_TILE = 16;
+const int TOTAL_STREAM_BUFFERS = 4;
+const int TOTAL_STREAM_DECODERS = 2;
+const int TOTAL_STREAM_IMAGES = 4;
+const Uint32 STREAM_FRAME_TICKS = 66;
+
+enum StreamBufferState
+{
+	STREAM_BUFFER_FREE = 0,
+	STREAM_BUFFER_WRITING = 1,
+	STREAM_BUFFER_READY = 2,
+	STREAM_BUFFER_READING = 3
+};
+
 class LTexture
 {
 	public:
@@ -38,13 +67,17 @@ class LTexture
 		bool unlockTexture();
 		void* getPixels();
 		void copyPixels( void* pixels );
+		bool updateRects( void* pixels, int pitch, SDL_Rect* rects, int rectCount );
 		int getPitch();
 		Uint32 getPixel32( unsigned int x, unsigned int y );
 
+		bool replaceColor( Uint32 target, Uint32 replacement );
+
 	private:
 		SDL_Texture* mTexture;
 		void* mPixels;
 		int mPitch;
+		Uint32 mPixelFormat;
 
 		int mWidth;
 		int mHeight;
@@ -55,16 +88,61 @@ class DataStream
 	public:
 		DataStream();
 
-		bool loadMedia();
+		~DataStream();
+
+		bool openSequence( std::string pathPattern, int frameCount, Uint32 frameTicks );
 
 		void free();
 
-		void* getBuffer();
+		void* acquireFrame( int& pitch, SDL_Rect* dirtyRects, int& dirtyCount );
+		void releaseFrame();
+
+		int getFrameWidth();
+		int getFrameHeight();
+
+		int getDecodedFrames();
+		int getDroppedFrames();
+		int getStalls();
 
 	private:
-		SDL_Surface* mImages[ 4 ];
-		int mCurrentImage;
-		int mDelayFrames;
+		static int decoderThread( void* data );
+
+		void decode();
+
+		bool decodeFrame( int frame, Uint8* buffer );
+
+		int findDirtyRects( Uint8* frame, SDL_Rect* rects, int maxRects );
+
+		std::string mPathPattern;
+		int mFrameCount;
+		Uint32 mFrameTicks;
+		int mFrameWidth;
+		int mFrameHeight;
+
+		Uint8* mBuffers[ TOTAL_STREAM_BUFFERS ];
+		StreamBufferState mBufferStates[ TOTAL_STREAM_BUFFERS ];
+		Uint32 mBufferTimestamps[ TOTAL_STREAM_BUFFERS ];
+		int mPitch;
+		int mReadingBuffer;
+
+		Uint8* mUploadedFrame;
+		bool mUploadedValid;
+
+		int mNextFrame;
+		Uint32 mStartTicks;
+		Uint32 mPresentedTimestamp;
+		Uint32 mStalledTimestamp;
+		bool mPresented;
+
+		SDL_Thread* mDecoders[ TOTAL_STREAM_DECODERS ];
+		int mDecoderCount;
+		SDL_mutex* mLock;
+		SDL_cond* mBufferFreed;
+		bool mQuit;
+
+		int mDecodedFrames;
+		int mDroppedFrames;
+		int mStalls;
 };
 
 bool init();
@@ -88,6 +166,7 @@ LTexture::LTexture()
 	mHeight = 0;
 	mPixels = NULL;
 	mPitch = 0;
+	mPixelFormat = SDL_PIXELFORMAT_UNKNOWN;
 }
 
 LTexture::~LTexture()
@@ -108,14 +187,19 @@ bool LTexture::loadFromFile( std::string path )
 	}
 	else
 	{
-		SDL_Surface* formattedSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
-		if( formattedSurface == NULL )
+		SDL_Surface* sourceSurface = loadedSurface;
+		if( SDL_ISPIXELFORMAT_INDEXED( loadedSurface->format->format ) )
+		{
+			sourceSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
+		}
+
+		if( sourceSurface == NULL )
 		{
 			printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
 		}
 		else
 		{
-			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, formattedSurface->w, formattedSurface->h );
+			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, sourceSurface->w, sourceSurface->h );
 			if( newTexture == NULL )
 			{
 				printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
@@ -124,34 +208,47 @@ bool LTexture::loadFromFile( std::string path )
 			{
 				SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
 
-				SDL_LockTexture( newTexture, &formattedSurface->clip_rect, &mPixels, &mPitch );
-
-				memcpy( mPixels, formattedSurface->pixels, formattedSurface->pitch * formattedSurface->h );
-
-				mWidth = formattedSurface->w;
-				mHeight = formattedSurface->h;
+				if( SDL_LockTexture( newTexture, NULL, &mPixels, &mPitch ) != 0 )
+				{
+					printf( "Unable to lock texture! %s\n", SDL_GetError() );
+					SDL_DestroyTexture( newTexture );
+					newTexture = NULL;
+				}
+				else
+				{
+					if( SDL_ConvertPixels( sourceSurface->w, sourceSurface->h, sourceSurface->format->format, sourceSurface->pixels, sourceSurface->pitch, SDL_PIXELFORMAT_RGBA8888, mPixels, mPitch ) != 0 )
+					{
+						printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
+						SDL_UnlockTexture( newTexture );
+						SDL_DestroyTexture( newTexture );
+						newTexture = NULL;
+					}
+					else
+					{
+						mWidth = sourceSurface->w;
+						mHeight = sourceSurface->h;
+						mPixelFormat = SDL_PIXELFORMAT_RGBA8888;
 
-				Uint32* pixels = (Uint32*)mPixels;
-				int pixelCount = ( mPitch / 4 ) * mHeight;
+						SDL_PixelFormat* mappingFormat = SDL_AllocFormat( SDL_PIXELFORMAT_RGBA8888 );
+						Uint32 colorKey = SDL_MapRGB( mappingFormat, 0, 0xFF, 0xFF );
+						Uint32 transparent = SDL_MapRGBA( mappingFormat, 0x00, 0xFF, 0xFF, 0x00 );
+						SDL_FreeFormat( mappingFormat );
 
-				Uint32 colorKey = SDL_MapRGB( formattedSurface->format, 0, 0xFF, 0xFF );
-				Uint32 transparent = SDL_MapRGBA( formattedSurface->format, 0x00, 0xFF, 0xFF, 0x00 );
+						replaceColor( colorKey, transparent );
 
-				for( int i = 0; i < pixelCount; ++i )
-				{
-					if( pixels[ i ] == colorKey )
-					{
-						pixels[ i ] = transparent;
+						SDL_UnlockTexture( newTexture );
 					}
+
+					mPixels = NULL;
 				}
+			}
 
-				SDL_UnlockTexture( newTexture );
-				mPixels = NULL;
+			if( sourceSurface != loadedSurface )
+			{
+				SDL_FreeSurface( sourceSurface );
 			}
+		}
 
-			SDL_FreeSurface( formattedSurface );
-		}	
-		
 		SDL_FreeSurface( loadedSurface );
 	}
 
@@ -164,7 +261,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -176,6 +273,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 		{
 			mWidth = textSurface->w;
 			mHeight = textSurface->h;
+			SDL_QueryTexture( mTexture, &mPixelFormat, NULL, NULL, NULL );
 		}
 
 		SDL_FreeSurface( textSurface );
@@ -201,6 +299,7 @@ bool LTexture::createBlank( int width, int height )
 	{
 		mWidth = width;
 		mHeight = height;
+		mPixelFormat = SDL_PIXELFORMAT_RGBA8888;
 	}
 
 	return mTexture != NULL;
@@ -216,6 +315,7 @@ void LTexture::free()
 		mHeight = 0;
 		mPixels = NULL;
 		mPitch = 0;
+		mPixelFormat = SDL_PIXELFORMAT_UNKNOWN;
 	}
 }
 
@@ -310,6 +410,70 @@ void LTexture::copyPixels( void* pixels )
 	}
 }
 
+bool LTexture::updateRects( void* pixels, int pitch, SDL_Rect* rects, int rectCount )
+{
+	bool success = true;
+
+	int bytesPerPixel = SDL_BYTESPERPIXEL( mPixelFormat );
+
+	SDL_Rect bounds = { 0, 0, mWidth, mHeight };
+	SDL_Rect merged[ MAX_DIRTY_RECTS ];
+	int mergedCount = 0;
+
+	for( int i = 0; i < rectCount; ++i )
+	{
+		SDL_Rect dirty;
+		if( !SDL_IntersectRect( &rects[ i ], &bounds, &dirty ) )
+		{
+			continue;
+		}
+
+		for( int j = 0; j < mergedCount; )
+		{
+			if( SDL_HasIntersection( &dirty, &merged[ j ] ) )
+			{
+				SDL_UnionRect( &dirty, &merged[ j ], &dirty );
+
+				--mergedCount;
+				merged[ j ] = merged[ mergedCount ];
+				j = 0;
+			}
+			else
+			{
+				++j;
+			}
+		}
+
+		if( mergedCount == MAX_DIRTY_RECTS )
+		{
+			for( int j = 1; j < mergedCount; ++j )
+			{
+				SDL_UnionRect( &merged[ 0 ], &merged[ j ], &merged[ 0 ] );
+			}
+			SDL_UnionRect( &merged[ 0 ], &dirty, &merged[ 0 ] );
+			mergedCount = 1;
+		}
+		else
+		{
+			merged[ mergedCount ] = dirty;
+			++mergedCount;
+		}
+	}
+
+	for( int i = 0; i < mergedCount; ++i )
+	{
+		Uint8* source = (Uint8*)pixels + merged[ i ].y * pitch + merged[ i ].x * bytesPerPixel;
+
+		if( SDL_UpdateTexture( mTexture, &merged[ i ], source, pitch ) != 0 )
+		{
+			printf( "Unable to update texture region! %s\n", SDL_GetError() );
+			success = false;
+		}
+	}
+
+	return success;
+}
+
 int LTexture::getPitch()
 {
 	return mPitch;
@@ -322,66 +486,532 @@ Uint32 LTexture::getPixel32( unsigned int x, unsigned int y )
     return pixels[ ( y * ( mPitch / 4 ) ) + x ];
 }
 
-DataStream::DataStream()
+bool LTexture::replaceColor( Uint32 target, Uint32 replacement )
 {
-	mImages[ 0 ] = NULL;
-	mImages[ 1 ] = NULL;
-	mImages[ 2 ] = NULL;
-	mImages[ 3 ] = NULL;
+	if( mPixels == NULL )
+	{
+		printf( "Texture is not locked!\n" );
+		return false;
+	}
+
+#if defined( PIXEL_AVX2 )
+	__m256i wideTarget = _mm256_set1_epi32( (int)target );
+	__m256i wideReplacement = _mm256_set1_epi32( (int)replacement );
+#elif defined( PIXEL_SSE2 )
+	__m128i wideTarget = _mm_set1_epi32( (int)target );
+	__m128i wideReplacement = _mm_set1_epi32( (int)replacement );
+#elif defined( PIXEL_NEON )
+	uint32x4_t wideTarget = vdupq_n_u32( target );
+	uint32x4_t wideReplacement = vdupq_n_u32( replacement );
+#endif
 
-	mCurrentImage = 0;
-	mDelayFrames = 4;
+	for( int y = 0; y < mHeight; ++y )
+	{
+		Uint32* row = (Uint32*)( (Uint8*)mPixels + y * mPitch );
+		int x = 0;
+
+#if defined( PIXEL_AVX2 )
+		for( ; x + 8 <= mWidth; x += 8 )
+		{
+			__m256i pixels = _mm256_loadu_si256( (__m256i*)&row[ x ] );
+			__m256i mask = _mm256_cmpeq_epi32( pixels, wideTarget );
+			_mm256_storeu_si256( (__m256i*)&row[ x ], _mm256_blendv_epi8( pixels, wideReplacement, mask ) );
+		}
+#elif defined( PIXEL_SSE2 )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			__m128i pixels = _mm_loadu_si128( (__m128i*)&row[ x ] );
+			__m128i mask = _mm_cmpeq_epi32( pixels, wideTarget );
+			_mm_storeu_si128( (__m128i*)&row[ x ], _mm_or_si128( _mm_and_si128( mask, wideReplacement ), _mm_andnot_si128( mask, pixels ) ) );
+		}
+#elif defined( PIXEL_NEON )
+		for( ; x + 4 <= mWidth; x += 4 )
+		{
+			uint32x4_t pixels = vld1q_u32( &row[ x ] );
+			uint32x4_t mask = vceqq_u32( pixels, wideTarget );
+			vst1q_u32( &row[ x ], vbslq_u32( mask, wideReplacement, pixels ) );
+		}
+#endif
+
+		for( ; x < mWidth; ++x )
+		{
+			if( row[ x ] == target )
+			{
+				row[ x ] = replacement;
+			}
+		}
+	}
+
+	return true;
 }
 
-bool DataStream::loadMedia()
+DataStream::DataStream()
 {
-	bool success = true;
-	
-	for( int i = 0; i < 4; ++i )
+	mFrameCount = 0;
+	mFrameTicks = 0;
+	mFrameWidth = 0;
+	mFrameHeight = 0;
+
+	for( int i = 0; i < TOTAL_STREAM_BUFFERS; ++i )
 	{
-		char path[ 64 ] = "";
-		sprintf( path, "42_texture_streaming/foo_walk_%d.png", i );
+		mBuffers[ i ] = NULL;
+		mBufferStates[ i ] = STREAM_BUFFER_FREE;
+		mBufferTimestamps[ i ] = 0;
+	}
+	mPitch = 0;
+	mReadingBuffer = -1;
+
+	mUploadedFrame = NULL;
+	mUploadedValid = false;
+
+	mNextFrame = 0;
+	mStartTicks = 0;
+	mPresentedTimestamp = 0;
+	mStalledTimestamp = 0;
+	mPresented = false;
+
+	mDecoderCount = 0;
+	mLock = NULL;
+	mBufferFreed = NULL;
+	mQuit = false;
+
+	mDecodedFrames = 0;
+	mDroppedFrames = 0;
+	mStalls = 0;
+}
+
+DataStream::~DataStream()
+{
+	free();
+}
+
+bool DataStream::openSequence( std::string pathPattern, int frameCount, Uint32 frameTicks )
+{
+	free();
+
+	mPathPattern = pathPattern;
+	mFrameCount = frameCount;
+	mFrameTicks = frameTicks;
 
-		SDL_Surface* loadedSurface = IMG_Load( path );
-		if( loadedSurface == NULL )
+	char path[ 256 ] = "";
+	SDL_snprintf( path, sizeof( path ), pathPattern.c_str(), 0 );
+
+	SDL_Surface* firstFrame = IMG_Load( path );
+	if( ( frameCount <= 0 ) || ( firstFrame == NULL ) )
+	{
+		printf( "Unable to open image sequence %s!\n", pathPattern.c_str() );
+		if( firstFrame != NULL )
 		{
-			printf( "Unable to load %s! SDL_image error: %s\n", path, IMG_GetError() );
-			success = false;
+			SDL_FreeSurface( firstFrame );
 		}
-		else
+		return false;
+	}
+
+	mFrameWidth = firstFrame->w;
+	mFrameHeight = firstFrame->h;
+	SDL_FreeSurface( firstFrame );
+
+	mPitch = ( mFrameWidth * 4 + STREAM_PITCH_ALIGN - 1 ) / STREAM_PITCH_ALIGN * STREAM_PITCH_ALIGN;
+	for( int i = 0; i < TOTAL_STREAM_BUFFERS; ++i )
+	{
+		mBuffers[ i ] = new Uint8[ mPitch * mFrameHeight ];
+	}
+	mUploadedFrame = new Uint8[ mPitch * mFrameHeight ];
+
+	if( !decodeFrame( 0, mBuffers[ 0 ] ) )
+	{
+		printf( "Unable to open image sequence %s!\n", pathPattern.c_str() );
+		free();
+		return false;
+	}
+
+	mBufferStates[ 0 ] = STREAM_BUFFER_READY;
+	mBufferTimestamps[ 0 ] = 0;
+	mNextFrame = 1;
+	mDecodedFrames = 1;
+
+	mLock = SDL_CreateMutex();
+	mBufferFreed = SDL_CreateCond();
+	if( mLock == NULL || mBufferFreed == NULL )
+	{
+		printf( "Unable to create stream lock! SDL Error: %s\n", SDL_GetError() );
+		free();
+		return false;
+	}
+
+	mQuit = false;
+	for( int i = 0; i < TOTAL_STREAM_DECODERS; ++i )
+	{
+		mDecoders[ mDecoderCount ] = SDL_CreateThread( decoderThread, "StreamDecoder", this );
+		if( mDecoders[ mDecoderCount ] == NULL )
 		{
-			mImages[ i ] = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
+			printf( "Unable to create stream decoder! SDL Error: %s\n", SDL_GetError() );
+			break;
 		}
 
-		SDL_FreeSurface( loadedSurface );
+		++mDecoderCount;
 	}
 
-	return success;
+	if( mDecoderCount == 0 )
+	{
+		free();
+		return false;
+	}
+
+	return true;
 }
 
 void DataStream::free()
 {
-	for( int i = 0; i < 4; ++i )
+	if( mLock != NULL )
 	{
-		SDL_FreeSurface( mImages[ i ] );
+		SDL_LockMutex( mLock );
+		mQuit = true;
+		SDL_CondBroadcast( mBufferFreed );
+		SDL_UnlockMutex( mLock );
 	}
+
+	for( int i = 0; i < mDecoderCount; ++i )
+	{
+		SDL_WaitThread( mDecoders[ i ], NULL );
+	}
+	mDecoderCount = 0;
+
+	if( mBufferFreed != NULL )
+	{
+		SDL_DestroyCond( mBufferFreed );
+		mBufferFreed = NULL;
+	}
+
+	if( mLock != NULL )
+	{
+		SDL_DestroyMutex( mLock );
+		mLock = NULL;
+	}
+
+	for( int i = 0; i < TOTAL_STREAM_BUFFERS; ++i )
+	{
+		delete[] mBuffers[ i ];
+		mBuffers[ i ] = NULL;
+		mBufferStates[ i ] = STREAM_BUFFER_FREE;
+	}
+	mReadingBuffer = -1;
+
+	delete[] mUploadedFrame;
+	mUploadedFrame = NULL;
+	mUploadedValid = false;
+
+	mNextFrame = 0;
+	mStartTicks = 0;
+	mStalledTimestamp = 0;
+	mPresented = false;
 }
 
-void* DataStream::getBuffer()
+void* DataStream::acquireFrame( int& pitch, SDL_Rect* dirtyRects, int& dirtyCount )
 {
-	--mDelayFrames;
-	if( mDelayFrames == 0 )
+	if( mLock == NULL || mReadingBuffer >= 0 )
 	{
-		++mCurrentImage;
-		mDelayFrames = 4;
+		return NULL;
 	}
 
-	if( mCurrentImage == 4 )
+	Uint32 now = SDL_GetTicks();
+	if( !mPresented )
 	{
-		mCurrentImage = 0;
+		mStartTicks = now;
 	}
+	Uint32 clock = now - mStartTicks;
+
+	SDL_LockMutex( mLock );
 
-	return mImages[ mCurrentImage ]->pixels;
+	int due = -1;
+	for( int i = 0; i < TOTAL_STREAM_BUFFERS; ++i )
+	{
+		if( mBufferStates[ i ] == STREAM_BUFFER_READY && mBufferTimestamps[ i ] <= clock && ( !mPresented || mBufferTimestamps[ i ] > mPresentedTimestamp ) && ( due < 0 || mBufferTimestamps[ i ] > mBufferTimestamps[ due ] ) )
+		{
+			due = i;
+		}
+	}
+
+	for( int i = 0; i < TOTAL_STREAM_BUFFERS; ++i )
+	{
+		if( i != due && mBufferStates[ i ] == STREAM_BUFFER_READY && ( ( due >= 0 && mBufferTimestamps[ i ] < mBufferTimestamps[ due ] ) || ( mPresented && mBufferTimestamps[ i ] <= mPresentedTimestamp ) ) )
+		{
+			mBufferStates[ i ] = STREAM_BUFFER_FREE;
+			++mDroppedFrames;
+			SDL_CondSignal( mBufferFreed );
+		}
+	}
+
+	if( due >= 0 )
+	{
+		mBufferStates[ due ] = STREAM_BUFFER_READING;
+		mReadingBuffer = due;
+		mPresentedTimestamp = mBufferTimestamps[ due ];
+		mPresented = true;
+	}
+	else if( mPresented && clock >= mPresentedTimestamp + mFrameTicks && mStalledTimestamp != mPresentedTimestamp + mFrameTicks )
+	{
+		mStalledTimestamp = mPresentedTimestamp + mFrameTicks;
+		++mStalls;
+	}
+
+	SDL_UnlockMutex( mLock );
+
+	if( due < 0 )
+	{
+		return NULL;
+	}
+
+	pitch = mPitch;
+	dirtyCount = findDirtyRects( mBuffers[ due ], dirtyRects, MAX_DIRTY_RECTS );
+	return mBuffers[ due ];
+}
+
+void DataStream::releaseFrame()
+{
+	if( mReadingBuffer < 0 )
+	{
+		return;
+	}
+
+	SDL_LockMutex( mLock );
+	mBufferStates[ mReadingBuffer ] = STREAM_BUFFER_FREE;
+	mReadingBuffer = -1;
+	SDL_CondSignal( mBufferFreed );
+	SDL_UnlockMutex( mLock );
+}
+
+int DataStream::getFrameWidth()
+{
+	return mFrameWidth;
+}
+
+int DataStream::getFrameHeight()
+{
+	return mFrameHeight;
+}
+
+int DataStream::getDecodedFrames()
+{
+	if( mLock == NULL )
+	{
+		return mDecodedFrames;
+	}
+
+	SDL_LockMutex( mLock );
+	int count = mDecodedFrames;
+	SDL_UnlockMutex( mLock );
+
+	return count;
+}
+
+int DataStream::getDroppedFrames()
+{
+	if( mLock == NULL )
+	{
+		return mDroppedFrames;
+	}
+
+	SDL_LockMutex( mLock );
+	int count = mDroppedFrames;
+	SDL_UnlockMutex( mLock );
+
+	return count;
+}
+
+int DataStream::getStalls()
+{
+	if( mLock == NULL )
+	{
+		return mStalls;
+	}
+
+	SDL_LockMutex( mLock );
+	int count = mStalls;
+	SDL_UnlockMutex( mLock );
+
+	return count;
+}
+
+int DataStream::decoderThread( void* data )
+{
+	( (DataStream*)data )->decode();
+
+	return 0;
+}
+
+void DataStream::decode()
+{
+	SDL_LockMutex( mLock );
+
+	while( !mQuit )
+	{
+		int buffer = -1;
+
+		while( !mQuit )
+		{
+			for( int i = 0; i < TOTAL_STREAM_BUFFERS && buffer < 0; ++i )
+			{
+				if( mBufferStates[ i ] == STREAM_BUFFER_FREE )
+				{
+					buffer = i;
+				}
+			}
+
+			if( buffer >= 0 )
+			{
+				break;
+			}
+
+			SDL_CondWait( mBufferFreed, mLock );
+		}
+
+		if( mQuit )
+		{
+			break;
+		}
+
+		int frame = mNextFrame;
+		++mNextFrame;
+
+		mBufferStates[ buffer ] = STREAM_BUFFER_WRITING;
+		SDL_UnlockMutex( mLock );
+
+		bool decoded = decodeFrame( frame, mBuffers[ buffer ] );
+
+		SDL_LockMutex( mLock );
+		if( decoded )
+		{
+			mBufferStates[ buffer ] = STREAM_BUFFER_READY;
+			mBufferTimestamps[ buffer ] = (Uint32)frame * mFrameTicks;
+			++mDecodedFrames;
+		}
+		else
+		{
+			mBufferStates[ buffer ] = STREAM_BUFFER_FREE;
+			++mDroppedFrames;
+
+			SDL_CondWaitTimeout( mBufferFreed, mLock, mFrameTicks );
+		}
+	}
+
+	SDL_UnlockMutex( mLock );
+}
+
+bool DataStream::decodeFrame( int frame, Uint8* buffer )
+{
+	bool success = true;
+
+	char path[ 256 ] = "";
+	SDL_snprintf( path, sizeof( path ), mPathPattern.c_str(), frame % mFrameCount );
+
+	SDL_Surface* loadedSurface = IMG_Load( path );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load %s! SDL_image error: %s\n", path, IMG_GetError() );
+		success = false;
+	}
+	else
+	{
+		if( ( loadedSurface->w != mFrameWidth ) || ( loadedSurface->h != mFrameHeight ) )
+		{
+			printf( "Unexpected frame size in %s!\n", path );
+			success = false;
+		}
+		else if( SDL_ConvertPixels( loadedSurface->w, loadedSurface->h, loadedSurface->format->format, loadedSurface->pixels, loadedSurface->pitch, SDL_PIXELFORMAT_RGBA8888, buffer, mPitch ) != 0 )
+		{
+			printf( "Unable to convert %s! SDL Error: %s\n", path, SDL_GetError() );
+			success = false;
+		}
+
+		SDL_FreeSurface( loadedSurface );
+	}
+
+	return success;
+}
+
+int DataStream::findDirtyRects( Uint8* frame, SDL_Rect* rects, int maxRects )
+{
+	int rowBytes = mFrameWidth * 4;
+
+	if( !mUploadedValid )
+	{
+		for( int y = 0; y < mFrameHeight; ++y )
+		{
+			memcpy( mUploadedFrame + y * mPitch, frame + y * mPitch, rowBytes );
+		}
+		mUploadedValid = true;
+
+		rects[ 0 ].x = 0;
+		rects[ 0 ].y = 0;
+		rects[ 0 ].w = mFrameWidth;
+		rects[ 0 ].h = mFrameHeight;
+		return 1;
+	}
+
+	int tileColumns = ( mFrameWidth + STREAM_DIRTY_TILE - 1 ) / STREAM_DIRTY_TILE;
+	int rectCount = 0;
+
+	for( int bandY = 0; bandY < mFrameHeight; bandY += STREAM_DIRTY_TILE )
+	{
+		int bandHeight = SDL_min( STREAM_DIRTY_TILE, mFrameHeight - bandY );
+
+		int firstColumn = tileColumns;
+		int lastColumn = -1;
+		for( int y = bandY; y < bandY + bandHeight; ++y )
+		{
+			Uint8* row = frame + y * mPitch;
+			Uint8* uploadedRow = mUploadedFrame + y * mPitch;
+
+			for( int column = 0; column < tileColumns; ++column )
+			{
+				if( column >= firstColumn && column <= lastColumn )
+				{
+					continue;
+				}
+
+				int x = column * STREAM_DIRTY_TILE;
+				int bytes = SDL_min( STREAM_DIRTY_TILE, mFrameWidth - x ) * 4;
+				if( memcmp( row + x * 4, uploadedRow + x * 4, bytes ) != 0 )
+				{
+					firstColumn = SDL_min( firstColumn, column );
+					lastColumn = SDL_max( lastColumn, column );
+				}
+			}
+		}
+
+		if( lastColumn < 0 )
+		{
+			continue;
+		}
+
+		SDL_Rect band;
+		band.x = firstColumn * STREAM_DIRTY_TILE;
+		band.y = bandY;
+		band.w = SDL_min( ( lastColumn + 1 ) * STREAM_DIRTY_TILE, mFrameWidth ) - band.x;
+		band.h = bandHeight;
+
+		for( int y = band.y; y < band.y + band.h; ++y )
+		{
+			memcpy( mUploadedFrame + y * mPitch + band.x * 4, frame + y * mPitch + band.x * 4, band.w * 4 );
+		}
+
+		if( rectCount > 0 && rects[ rectCount - 1 ].x == band.x && rects[ rectCount - 1 ].w == band.w && rects[ rectCount - 1 ].y + rects[ rectCount - 1 ].h == band.y )
+		{
+			rects[ rectCount - 1 ].h += band.h;
+		}
+		else if( rectCount < maxRects )
+		{
+			rects[ rectCount ] = band;
+			++rectCount;
+		}
+		else
+		{
+			SDL_UnionRect( &rects[ rectCount - 1 ], &band, &rects[ rectCount - 1 ] );
+		}
+	}
+
+	return rectCount;
 }
 
 bool init()
@@ -437,17 +1067,16 @@ bool loadMedia()
 {
 	bool success = true;
 
-	if( !gStreamingTexture.createBlank( 64, 205 ) )
-	{
-		printf( "Failed to create streaming texture!\n" );
-		success = false;
-	}
-
-	if( !gDataStream.loadMedia() )
+	if( !gDataStream.openSequence( "42_texture_streaming/foo_walk_%d.png", TOTAL_STREAM_IMAGES, STREAM_FRAME_TICKS ) )
 	{		
 		printf( "Unable to load data stream!\n" );
 		success = false;
 	}
+	else if( !gStreamingTexture.createBlank( gDataStream.getFrameWidth(), gDataStream.getFrameHeight() ) )
+	{
+		printf( "Failed to create streaming texture!\n" );
+		success = false;
+	}
 
 	return success;
 }
@@ -455,6 +1084,8 @@ bool loadMedia()
 void close()
 {
 	gStreamingTexture.free();
+
+	printf( "Data stream: %d frames decoded, %d dropped, %d playback stalls\n", gDataStream.getDecodedFrames(), gDataStream.getDroppedFrames(), gDataStream.getStalls() );
 	gDataStream.free();
 
 	SDL_DestroyRenderer( gRenderer );
@@ -497,9 +1128,15 @@ int main( int argc, char* args[] )
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
-				gStreamingTexture.lockTexture();
-				gStreamingTexture.copyPixels( gDataStream.getBuffer() );
-				gStreamingTexture.unlockTexture();
+				int pitch = 0;
+				SDL_Rect dirtyRects[ MAX_DIRTY_RECTS ];
+				int dirtyCount = 0;
+				void* frame = gDataStream.acquireFrame( pitch, dirtyRects, dirtyCount );
+				if( frame != NULL )
+				{
+					gStreamingTexture.updateRects( frame, pitch, dirtyRects, dirtyCount );
+					gDataStream.releaseFrame();
+				}
 
 				gStreamingTexture.render( ( SCREEN_WIDTH - gStreamingTexture.getWidth() ) / 2, ( SCREEN_HEIGHT - gStreamingTexture.getHeight() ) / 2 );
 
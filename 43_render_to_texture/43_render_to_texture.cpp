@@ -91,14 +91,19 @@ bool LTexture::loadFromFile( std::string path )
 	}
 	else
 	{
-		SDL_Surface* formattedSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
-		if( formattedSurface == NULL )
+		SDL_Surface* sourceSurface = loadedSurface;
+		if( SDL_ISPIXELFORMAT_INDEXED( loadedSurface->format->format ) )
+		{
+			sourceSurface = SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_RGBA8888, NULL );
+		}
+
+		if( sourceSurface == NULL )
 		{
 			printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
 		}
 		else
 		{
-			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, formattedSurface->w, formattedSurface->h );
+			newTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, sourceSurface->w, sourceSurface->h );
 			if( newTexture == NULL )
 			{
 				printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
@@ -107,34 +112,55 @@ bool LTexture::loadFromFile( std::string path )
 			{
 				SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
 
-				SDL_LockTexture( newTexture, &formattedSurface->clip_rect, &mPixels, &mPitch );
-
-				memcpy( mPixels, formattedSurface->pixels, formattedSurface->pitch * formattedSurface->h );
-
-				mWidth = formattedSurface->w;
-				mHeight = formattedSurface->h;
-
-				Uint32* pixels = (Uint32*)mPixels;
-				int pixelCount = ( mPitch / 4 ) * mHeight;
-
-				Uint32 colorKey = SDL_MapRGB( formattedSurface->format, 0, 0xFF, 0xFF );
-				Uint32 transparent = SDL_MapRGBA( formattedSurface->format, 0x00, 0xFF, 0xFF, 0x00 );
-
-				for( int i = 0; i < pixelCount; ++i )
+				if( SDL_LockTexture( newTexture, NULL, &mPixels, &mPitch ) != 0 )
 				{
-					if( pixels[ i ] == colorKey )
+					printf( "Unable to lock texture! %s\n", SDL_GetError() );
+					SDL_DestroyTexture( newTexture );
+					newTexture = NULL;
+				}
+				else
+				{
+					if( SDL_ConvertPixels( sourceSurface->w, sourceSurface->h, sourceSurface->format->format, sourceSurface->pixels, sourceSurface->pitch, SDL_PIXELFORMAT_RGBA8888, mPixels, mPitch ) != 0 )
+					{
+						printf( "Unable to convert loaded surface to display format! %s\n", SDL_GetError() );
+						SDL_UnlockTexture( newTexture );
+						SDL_DestroyTexture( newTexture );
+						newTexture = NULL;
+					}
+					else
 					{
-						pixels[ i ] = transparent;
+						mWidth = sourceSurface->w;
+						mHeight = sourceSurface->h;
+
+						Uint32* pixels = (Uint32*)mPixels;
+						int pixelCount = ( mPitch / 4 ) * mHeight;
+
+						SDL_PixelFormat* mappingFormat = SDL_AllocFormat( SDL_PIXELFORMAT_RGBA8888 );
+						Uint32 colorKey = SDL_MapRGB( mappingFormat, 0, 0xFF, 0xFF );
+						Uint32 transparent = SDL_MapRGBA( mappingFormat, 0x00, 0xFF, 0xFF, 0x00 );
+						SDL_FreeFormat( mappingFormat );
+
+						for( int i = 0; i < pixelCount; ++i )
+						{
+							if( pixels[ i ] == colorKey )
+							{
+								pixels[ i ] = transparent;
+							}
+						}
+
+						SDL_UnlockTexture( newTexture );
 					}
+
+					mPixels = NULL;
 				}
+			}
 
-				SDL_UnlockTexture( newTexture );
-				mPixels = NULL;
+			if( sourceSurface != loadedSurface )
+			{
+				SDL_FreeSurface( sourceSurface );
 			}
+		}
 
-			SDL_FreeSurface( formattedSurface );
-		}	
-		
 		SDL_FreeSurface( loadedSurface );
 	}
 
@@ -147,7 +173,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -6,6 +6,9 @@
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+const int SIMULATION_RATE = 120;
+const int MAX_SIMULATION_STEPS = 8;
+
 class LTexture
 {
 	public:
@@ -52,30 +55,6 @@ class LTexture
 		int mHeight;
 };
 
-class LTimer
-{
-    public:
-		LTimer();
-
-		void start();
-		void stop();
-		void pause();
-		void unpause();
-
-		Uint32 getTicks();
-
-		bool isStarted();
-		bool isPaused();
-
-    private:
-		Uint32 mStartTicks;
-
-		Uint32 mPausedTicks;
-
-		bool mPaused;
-		bool mStarted;
-};
-
 class Dot
 {
     public:
@@ -90,10 +69,11 @@ class Dot
 
 		void move( float timeStep );
 
-		void render();
+		void render( float alpha );
 
     private:
 		float mPosX, mPosY;
+		float mPrevX, mPrevY;
 		float mVelX, mVelY;
 };
 
@@ -192,7 +172,7 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 {
 	free();
 
-	SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
+	SDL_Surface* textSurface = TTF_RenderUTF8_Solid( gFont, textureText.c_str(), textColor );
 	if( textSurface != NULL )
 	{
         mTexture = SDL_CreateTextureFromSurface( gRenderer, textSurface );
@@ -356,93 +336,14 @@ Uint32 LTexture::getPixel32( unsigned int x, unsigned int y )
 }
 
 
-LTimer::LTimer()
-{
-    mStartTicks = 0;
-    mPausedTicks = 0;
-
-    mPaused = false;
-    mStarted = false;
-}
-
-void LTimer::start()
-{
-    mStarted = true;
-
-    mPaused = false;
-
-    mStartTicks = SDL_GetTicks();
-	mPausedTicks = 0;
-}
-
-void LTimer::stop()
-{
-    mStarted = false;
-
-    mPaused = false;
-
-	mStartTicks = 0;
-	mPausedTicks = 0;
-}
-
-void LTimer::pause()
-{
-    if( mStarted && !mPaused )
-    {
-        mPaused = true;
-
-        mPausedTicks = SDL_GetTicks() - mStartTicks;
-		mStartTicks = 0;
-    }
-}
-
-void LTimer::unpause()
-{
-    if( mStarted && mPaused )
-    {
-        mPaused = false;
-
-        mStartTicks = SDL_GetTicks() - mPausedTicks;
-
-        mPausedTicks = 0;
-    }
-}
-
-Uint32 LTimer::getTicks()
-{
-	Uint32 time = 0;
-
-    if( mStarted )
-    {
-        if( mPaused )
-        {
-            time = mPausedTicks;
-        }
-        else
-        {
-            time = SDL_GetTicks() - mStartTicks;
-        }
-    }
-
-    return time;
-}
-
-bool LTimer::isStarted()
-{
-    return mStarted;
-}
-
-bool LTimer::isPaused()
-{
-    return mPaused && mStarted;
-}
-
-
 Dot::Dot()
 {
     mPosX = 0;
     mPosY = 0;
 
+    mPrevX = 0;
+    mPrevY = 0;
+
     mVelX = 0;
     mVelY = 0;
 }
@@ -473,6 +374,9 @@ void Dot::handleEvent( SDL_Event& e )
 
 void Dot::move( float timeStep )
 {
+    mPrevX = mPosX;
+    mPrevY = mPosY;
+
     mPosX += mVelX * timeStep;
 
 	if( mPosX < 0 )
@@ -496,9 +400,12 @@ void Dot::move( float timeStep )
 	}
 }
 
-void Dot::render()
+void Dot::render( float alpha )
 {
-	gDotTexture.render( (int)mPosX, (int)mPosY );
+	float x = mPrevX + ( mPosX - mPrevX ) * alpha;
+	float y = mPrevY + ( mPosY - mPrevY ) * alpha;
+
+	gDotTexture.render( (int)( x + 0.5f ), (int)( y + 0.5f ) );
 }
 
 bool init()
@@ -594,7 +501,11 @@ int main( int argc, char* args[] )
 
 			Dot dot;
 
-			LTimer stepTimer;
+			Uint64 stepTicks = SDL_GetPerformanceFrequency() / SIMULATION_RATE;
+			float timeStep = (float)stepTicks / SDL_GetPerformanceFrequency();
+
+			Uint64 previousTicks = SDL_GetPerformanceCounter();
+			Uint64 accumulator = 0;
 
 			while( !quit )
 			{
@@ -608,16 +519,29 @@ int main( int argc, char* args[] )
 					dot.handleEvent( e );
 				}
 
-				float timeStep = stepTimer.getTicks() / 1000.f;
+				Uint64 currentTicks = SDL_GetPerformanceCounter();
+				accumulator += currentTicks - previousTicks;
+				previousTicks = currentTicks;
+
+				int steps = 0;
+				while( accumulator >= stepTicks && steps < MAX_SIMULATION_STEPS )
+				{
+					dot.move( timeStep );
+					accumulator -= stepTicks;
+					++steps;
+				}
 
-				dot.move( timeStep );
+				if( accumulator >= stepTicks )
+				{
+					accumulator %= stepTicks;
+				}
 
-				stepTimer.start();
+				float alpha = (float)accumulator / stepTicks;
 
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
 				SDL_RenderClear( gRenderer );
 
-				dot.render();
+				dot.render( alpha );
 
 				SDL_RenderPresent( gRenderer );
 			}